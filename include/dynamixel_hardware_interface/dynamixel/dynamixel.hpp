@@ -18,6 +18,7 @@
 #define DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL__DYNAMIXEL_HPP_
 
 #include "dynamixel_hardware_interface/dynamixel/dynamixel_info.hpp"
+#include "dynamixel_hardware_interface/log_ring.hpp"
 #include "dynamixel_sdk/dynamixel_sdk.h"
 
 #include <map>
@@ -25,6 +26,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <chrono>
 #include <cstdarg>
 #include <memory>
 
@@ -64,7 +66,9 @@ enum DxlError
   SET_READ_ITEM_FAIL = -14,        ///< Failed to set read item.
   SET_WRITE_ITEM_FAIL = -15,       ///< Failed to set write item.
   DLX_HARDWARE_ERROR = -16,        ///< Hardware error detected.
-  DXL_REBOOT_FAIL = -17            ///< Reboot failed.
+  DXL_REBOOT_FAIL = -17,           ///< Reboot failed.
+  BUS_TIMING_FAIL = -18,           ///< Baud rate / return delay time change failed.
+  DXL_NOT_FOUND = -19              ///< Some configured IDs did not answer the broadcast ping.
 };
 
 /**
@@ -78,6 +82,8 @@ typedef struct
   uint8_t size;                     ///< Total size in bytes.
   std::vector<std::string> item_name;  ///< Names of the control items.
   std::vector<uint8_t> item_size;  ///< Sizes of each control item in bytes.
+  std::vector<uint16_t> addr_table;  ///< Mapped control table address of every data byte.
+  bool direct;                      ///< No indirect address table, items are read in place.
 } IndirectInfo;
 
 /**
@@ -102,9 +108,101 @@ typedef struct
   std::vector<std::string> item_name;          ///< List of control item names.
   std::vector<uint8_t> item_size;              ///< Sizes of the control items.
   std::vector<uint16_t> item_addr;             ///< Addresses of the control items.
-  std::vector<std::shared_ptr<double>> item_data_ptr_vec;  ///< Pointers to the data.
+  std::vector<double *> item_data_ptr_vec;     ///< Pointers to the data.
+  uint16_t fast_item_cnt;                      ///< Leading items read every cycle (read only).
+  uint32_t read_divisor;                       ///< The other items are read every this many cycles.
 } RWItemList;
 
+/**
+ * @brief Conversion applied to a raw read value before it is stored.
+ */
+enum ReadConverter
+{
+  READ_CONV_RAW = 0,       ///< Stored as is.
+  READ_CONV_POSITION = 1,  ///< Position value to radian.
+  READ_CONV_VELOCITY = 2,  ///< Velocity value (0.01 rpm) to rad/s.
+  READ_CONV_CURRENT = 3    ///< Signed current value.
+};
+
+/**
+ * @struct ReadDecodeItem
+ * @brief One precompiled entry of the read decode plan.
+ */
+typedef struct
+{
+  uint8_t id;                       ///< ID of the Dynamixel motor.
+  uint16_t addr;                    ///< Address of the item inside the indirect data area.
+  uint8_t size;                     ///< Size of the item in bytes.
+  bool is_signed;                   ///< Sign-extend the raw value from `size` bytes.
+  ReadConverter converter;          ///< Conversion to apply to the raw value.
+  int32_t value_of_zero_radian_position;  ///< Position offset (READ_CONV_POSITION only).
+  double positive_radian_per_value;       ///< Scale above the zero position.
+  double negative_radian_per_value;       ///< Scale below the zero position.
+  double * data_ptr;                ///< Destination state value.
+} ReadDecodeItem;
+
+/**
+ * @struct ReadGroup
+ * @brief One prepared sync/bulk read: the fast items of every ID plus the slow items of some.
+ */
+typedef struct
+{
+  std::vector<uint8_t> id;                     ///< IDs in the read.
+  std::vector<uint16_t> addr;                  ///< Start address read from each ID.
+  std::vector<uint8_t> length;                 ///< Bytes read from each ID.
+  dynamixel::GroupSyncRead * sync_read;        ///< Sync read, nullptr if not used.
+  dynamixel::GroupFastSyncRead * fast_sync_read;  ///< Fast sync read, nullptr if not used.
+  dynamixel::GroupBulkRead * bulk_read;        ///< Bulk read, nullptr if not used.
+  dynamixel::GroupFastBulkRead * fast_bulk_read;  ///< Fast bulk read, nullptr if not used.
+  std::vector<ReadDecodeItem> decode_plan;     ///< Items decoded after the read.
+  uint16_t rx_packet_length;                   ///< Expected status packet bytes.
+} ReadGroup;
+
+/**
+ * @brief Conversion applied to a command value before it is written.
+ */
+enum WriteConverter
+{
+  WRITE_CONV_RAW = 0,       ///< Written as is.
+  WRITE_CONV_POSITION = 1,  ///< Radian to position value.
+  WRITE_CONV_VELOCITY = 2,  ///< rad/s to velocity value (0.01 rpm).
+  WRITE_CONV_CURRENT = 3    ///< Effort to current value.
+};
+
+/**
+ * @struct WriteEncodeItem
+ * @brief One precompiled entry of the write encode plan.
+ */
+typedef struct
+{
+  uint8_t id;                       ///< ID of the Dynamixel motor.
+  uint16_t offset;                  ///< Offset of the item inside the write parameter buffer.
+  uint8_t size;                     ///< Size of the item in bytes.
+  WriteConverter converter;         ///< Conversion to apply to the command value.
+  int32_t value_of_zero_radian_position;  ///< Position offset (WRITE_CONV_POSITION only).
+  double positive_value_per_radian;       ///< Scale above the zero position.
+  double negative_value_per_radian;       ///< Scale below the zero position.
+  double torque_constant;           ///< Effort per current value (WRITE_CONV_CURRENT only).
+  double * data_ptr;                ///< Source command value.
+  uint16_t block;                   ///< Index of the WriteBlock the item belongs to.
+} WriteEncodeItem;
+
+/**
+ * @struct WriteBlock
+ * @brief Parameters of one ID inside the write parameter buffer, tracked for write elision.
+ */
+typedef struct
+{
+  uint8_t id;                       ///< ID of the Dynamixel motor.
+  uint16_t offset;                  ///< Offset of the ID byte inside the write parameter buffer.
+  uint16_t length;                  ///< Length of the block, ID byte included.
+  uint16_t first_item;              ///< First WriteEncodeItem of the block.
+  uint16_t item_cnt;                ///< Number of WriteEncodeItems of the block.
+  bool dirty;                       ///< Block has to go out in this cycle.
+  bool sent;                        ///< The servo holds the last sent values.
+  uint32_t skipped_cycles;          ///< Cycles since the block was last sent.
+} WriteBlock;
+
 class Dynamixel
 {
 private:
@@ -123,26 +221,52 @@ private:
   // read item (sync or bulk) variable
   bool read_type_;
   std::vector<RWItemList> read_data_list_;
-
-  // sync read
-  dynamixel::GroupSyncRead * group_sync_read_;
-  // indirect inform for sync read
+  // prepared reads compiled from read_data_list_ in SetMultiDxlRead(), group of every cycle
+  std::vector<ReadGroup> read_groups_;
+  std::vector<uint16_t> read_schedule_;
+  size_t read_cycle_;
+  // group of the read in flight or last read, nullptr before SetMultiDxlRead()
+  ReadGroup * active_read_;
+  // read request sent by RequestMultiDxlData(), not yet collected
+  bool read_requested_;
+  // duration of the last ReadMultiDxlData() phases [ns]
+  int64_t read_txrx_ns_;
+  int64_t read_decode_ns_;
+
+  // sensors: one bulk read per read divisor after the servo read, failing on their own
+  std::vector<RWItemList> sensor_read_data_list_;
+  std::vector<ReadGroup> sensor_read_groups_;
+  std::vector<uint32_t> sensor_read_divisor_;  // of every sensor read group
+  size_t sensor_read_cycle_;
+
+  // fast sync read (Protocol 2.0, 0x8A) and fast bulk read (0x9A)
+  bool use_fast_read_;
+  // indirect inform for sync/bulk read
   std::map<uint8_t /*id*/, IndirectInfo> indirect_info_read_;
 
-  // bulk read
-  dynamixel::GroupBulkRead * group_bulk_read_;
-
   // write item (sync or bulk) variable
   bool write_type_;
   std::vector<RWItemList> write_data_list_;
+  // flat encode plan compiled from write_data_list_ in SetMultiDxlWrite()
+  std::vector<WriteEncodeItem> write_encode_plan_;
+  // sync/bulk write parameters, updated in place every cycle
+  std::vector<uint8_t> write_param_buf_;
+  // instruction packet assembled from write_param_buf_, reused every cycle
+  std::vector<uint8_t> write_tx_packet_;
+  // write elision: IDs whose encoded goals did not change are left out of the packet
+  bool use_write_elision_;
+  uint32_t write_deadband_;
+  uint32_t write_refresh_cycles_;
+  uint16_t write_header_size_;
+  std::vector<WriteBlock> write_blocks_;
+  std::vector<int32_t> write_value_;       // encoded value of every plan item, this cycle
+  std::vector<int32_t> write_sent_value_;  // encoded value of every plan item, last sent
 
-  // sync write
-  dynamixel::GroupSyncWrite * group_sync_write_;
   // indirect inform for sync write
   std::map<uint8_t /*id*/, IndirectInfo> indirect_info_write_;
 
-  // bulk write
-  dynamixel::GroupBulkWrite * group_bulk_write_;
+  // failures of the cyclic read / write go here instead of stderr when set
+  LogRing * log_ring_;
 
 public:
   explicit Dynamixel(const char * path);
@@ -151,24 +275,43 @@ public:
   // DXL Communication Setting
   DxlError InitDxlComm(std::vector<uint8_t> id_arr, std::string port_name, std::string baudrate);
   DxlError Reboot(uint8_t id);
+  DxlError OptimizeBusTiming(
+    std::vector<uint8_t> id_arr, int target_baudrate, std::vector<uint8_t> & fail_id_arr);
+  int GetBaudRate() const {return port_handler_->getBaudRate();}
   void RWDataReset();
 
   // DXL Read Setting
+  // Items from fast_item_cnt on are read every read_divisor cycles, round-robin over the IDs
   DxlError SetDxlReadItems(
     uint8_t id, std::vector<std::string> item_names,
-    std::vector<std::shared_ptr<double>> data_vec_ptr);
+    std::vector<double *> data_vec_ptr,
+    uint32_t read_divisor = 1, size_t fast_item_cnt = 0);
+  // Sensors are read by a bulk read of their own, every read_divisor cycles. A failed sensor
+  // read keeps the last sensor values and does not fail ReadMultiDxlData()
+  DxlError SetDxlSensorReadItems(
+    uint8_t id, std::vector<std::string> item_names,
+    std::vector<double *> data_vec_ptr, uint32_t read_divisor = 1);
   DxlError SetMultiDxlRead();
+  void SetFastReadMode(bool use_fast_read) {use_fast_read_ = use_fast_read;}
 
   // DXL Write Setting
   DxlError SetDxlWriteItems(
     uint8_t id, std::vector<std::string> item_names,
-    std::vector<std::shared_ptr<double>> data_vec_ptr);
+    std::vector<double *> data_vec_ptr);
   DxlError SetMultiDxlWrite();
+  void SetWriteElision(bool use_write_elision, uint32_t deadband, uint32_t refresh_cycles);
+  // Log ring for the failures of the cyclic read / write, nullptr prints them to stderr
+  void SetLogRing(LogRing * log_ring) {log_ring_ = log_ring;}
 
   // Read Item (sync or bulk)
   DxlError ReadMultiDxlData();
+  // Send the read request only, the next ReadMultiDxlData() collects the response
+  DxlError RequestMultiDxlData();
   // Write Item (sync or bulk)
   DxlError WriteMultiDxlData();
+  // Bus round trip and decode time of the last ReadMultiDxlData() [ns]
+  int64_t GetReadTxRxTime() const {return read_txrx_ns_;}
+  int64_t GetReadDecodeTime() const {return read_decode_ns_;}
 
   // Set Dxl Option
   DxlError SetOperatingMode(uint8_t id, uint8_t dynamixel_mode);
@@ -178,6 +321,8 @@ public:
   // DXL Item Write
   DxlError WriteItem(uint8_t id, std::string item_name, uint32_t data);
   DxlError WriteItem(uint8_t id, uint16_t addr, uint8_t size, uint32_t data);
+  // Read-compare-write: only items whose value on the servo differs are written
+  DxlError SyncConfigItems(std::vector<RWItemBufInfo> & items);
   DxlError InsertWriteItemBuf(uint8_t id, std::string item_name, uint32_t data);
   DxlError WriteItemBuf();
 
@@ -189,13 +334,16 @@ public:
   uint32_t GetReadItemDataBuf(uint8_t id, std::string item_name);
 
   DynamixelInfo GetDxlInfo() {return dxl_info_;}
-  std::map<uint8_t, bool> GetDxlTorqueState() {return torque_state_;}
+  const std::map<uint8_t, bool> & GetDxlTorqueState() const {return torque_state_;}
 
   static std::string DxlErrorToString(DxlError error_num);
 
 private:
   bool checkReadType();
   bool checkWriteType();
+  DxlError MakeReadItemList(
+    uint8_t id, const std::vector<std::string> & item_names,
+    const std::vector<double *> & data_vec_ptr, RWItemList & read_item);
 
   // SyncRead
   DxlError SetSyncReadItemAndHandler();
@@ -207,6 +355,26 @@ private:
   DxlError SetBulkReadHandler(std::vector<uint8_t> id_arr);
   DxlError GetDxlValueFromBulkRead();
 
+  // Read - Packet (active sync/bulk read group)
+  int TxReadPacket();
+  int RxReadPacket();
+  int TxRxReadPacket();
+  void FinishReadRequest();
+  void NextReadGroup();
+
+  // Read - Groups and Decode Plan
+  DxlError SetReadGroups();
+  DxlError AddReadGroup(const std::vector<bool> & slow, bool & fast_read);
+  void ClearReadGroups();
+  void AddReadDecodeItems(
+    const RWItemList & read_data, uint16_t item_cnt, std::vector<ReadDecodeItem> & plan);
+  double DecodeReadItem(const ReadDecodeItem & item, uint32_t raw) const;
+
+  // Read - Sensors
+  DxlError SetSensorReadGroups();
+  void ClearSensorReadGroups();
+  void ReadSensorData();
+
   // Read - Indirect Address
   void ResetIndirectRead(std::vector<uint8_t> id_arr);
   DxlError AddIndirectRead(
@@ -225,6 +393,20 @@ private:
   DxlError SetBulkWriteHandler(std::vector<uint8_t> id_arr);
   DxlError SetDxlValueToBulkWrite();
 
+  // Write - Encode Plan
+  void BuildWriteEncodePlan();
+  void EncodeWriteItems();
+  int TxWritePacket(uint8_t instruction);
+  void InvalidateWriteBlock(uint8_t id);
+
+  // Discovery
+  DxlError DiscoverDxl(
+    const std::vector<uint8_t> & id_arr, std::map<uint8_t, uint16_t> & model_num);
+  DxlError PingDxl(const std::vector<uint8_t> & id_arr, std::map<uint8_t, uint16_t> & model_num);
+
+  // Bus timing
+  bool PingAll(const std::vector<uint8_t> & id_arr);
+
   // Write - Indirect Address
   void ResetIndirectWrite(std::vector<uint8_t> id_arr);
   DxlError AddIndirectWrite(
@@ -232,6 +414,21 @@ private:
     std::string item_name,
     uint16_t item_addr,
     uint8_t item_size);
+
+  // Indirect Address - sends the address tables built by AddIndirectRead/Write
+  DxlError UpdateIndirectAddr(
+    const std::vector<uint8_t> & id_arr,
+    const std::map<uint8_t, IndirectInfo> & indirect_info,
+    const std::string & addr_item_name);
+  DxlError FindStaleIndirectAddr(
+    const std::vector<uint8_t> & id_arr,
+    const std::map<uint8_t, IndirectInfo> & indirect_info,
+    const std::string & addr_item_name,
+    std::vector<uint8_t> & stale_id_arr);
+  DxlError WriteIndirectAddr(
+    const std::vector<uint8_t> & id_arr,
+    const std::map<uint8_t, IndirectInfo> & indirect_info,
+    const std::string & addr_item_name);
 };
 
 }  // namespace dynamixel_hardware_interface
@@ -23,7 +23,9 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/algorithm/string.hpp>
@@ -38,6 +40,9 @@ typedef struct
   std::string item_name;
 } ControlItem;
 
+// item name -> control item
+using ControlItemIndex = std::unordered_map<std::string, ControlItem>;
+
 typedef  struct
 {
   double torque_constant;
@@ -49,19 +54,96 @@ typedef  struct
   uint16_t model_num;
 
   std::vector<ControlItem> item;
+  ControlItemIndex item_index;
 } DxlInfo;
 
+// Control table compiled into the library, generated from param/dxl_model at build time
+typedef struct
+{
+  uint16_t address;
+  uint8_t size;
+  const char * item_name;
+} BuiltinControlItem;
+
+typedef struct
+{
+  uint16_t model_num;
+  double torque_constant;
+  double min_radian;
+  double max_radian;
+  int32_t value_of_zero_radian_position;
+  int32_t value_of_max_radian_position;
+  int32_t value_of_min_radian_position;
+  const BuiltinControlItem * item;
+  size_t item_cnt;
+} BuiltinDxlModel;
+
+constexpr bool BuiltinNameEqual(const char * a, const char * b)
+{
+  return *a == *b && (*a == '\0' || BuiltinNameEqual(a + 1, b + 1));
+}
+
+// Compile time item lookup in a builtin control table, nullptr if the model has no such item
+constexpr const BuiltinControlItem * FindBuiltinControlItem(
+  const BuiltinDxlModel & model, const char * item_name)
+{
+  for (size_t i = 0; i < model.item_cnt; i++) {
+    if (BuiltinNameEqual(model.item[i].item_name, item_name)) {
+      return &model.item[i];
+    }
+  }
+  return nullptr;
+}
+
+// Builtin model of a model number, nullptr if the model is not compiled in
+const BuiltinDxlModel * FindBuiltinDxlModel(uint16_t model_num);
+size_t GetBuiltinDxlModelCount();
+
+// Binary model file (<name>.model.bin) generated from the text model file at build time.
+// Layout: header, item_count records, name table. Host byte order.
+static constexpr char DXL_MODEL_BIN_MAGIC[4] = {'D', 'X', 'L', 'M'};
+static constexpr uint16_t DXL_MODEL_BIN_VERSION = 1;
+
+typedef struct
+{
+  char magic[4];
+  uint16_t version;
+  uint16_t reserved;
+  uint32_t item_count;
+  uint32_t name_table_size;
+  double torque_constant;
+  double min_radian;
+  double max_radian;
+  int32_t value_of_zero_radian_position;
+  int32_t value_of_max_radian_position;
+  int32_t value_of_min_radian_position;
+  int32_t reserved2;
+} DxlModelBinHeader;
+
+typedef struct
+{
+  uint16_t address;
+  uint8_t size;
+  uint8_t name_length;
+  uint32_t name_offset;  // into the name table, names are not terminated
+} DxlModelBinItem;
+
+static_assert(sizeof(DxlModelBinHeader) == 56, "unexpected DxlModelBinHeader padding");
+static_assert(sizeof(DxlModelBinItem) == 8, "unexpected DxlModelBinItem padding");
+
 class DynamixelInfo
 {
 private:
   using DxlModelList = std::map<uint16_t, std::string>;
   DxlModelList dxl_model_list_;
+  // parsed once per model number, shared read-only by every ID of that model
+  std::map<uint16_t /*model_num*/, std::shared_ptr<const DxlInfo>> dxl_model_cache_;
 
   std::string dxl_model_file_dir;
 
 public:
   // Id, Control table
-  std::map<uint8_t, DxlInfo> dxl_info_;
+  std::map<uint8_t, std::shared_ptr<const DxlInfo>> dxl_info_;
 
   DynamixelInfo() {}
   ~DynamixelInfo() {}
@@ -70,25 +152,42 @@ public:
   void InitDxlModelInfo();
 
   void ReadDxlModelFile(uint8_t id, uint16_t model_num);
-  bool GetDxlControlItem(uint8_t id, std::string item_name, uint16_t & addr, uint8_t & size);
-  bool CheckDxlControlItem(uint8_t id, std::string item_name);
+  static bool ReadDxlModelText(const std::string & path, DxlInfo & dxl_info);
+  static bool ReadDxlModelBinary(const std::string & path, DxlInfo & dxl_info);
+  static bool WriteDxlModelBinary(const std::string & path, const DxlInfo & dxl_info);
+  bool GetDxlControlItem(
+    uint8_t id, const std::string & item_name, uint16_t & addr, uint8_t & size) const;
+  bool CheckDxlControlItem(uint8_t id, const std::string & item_name) const;
   bool GetDxlTypeInfo(
     uint8_t id,
     int32_t & value_of_zero_radian_position,
     int32_t & value_of_max_radian_position,
     int32_t & value_of_min_radian_position,
     double & min_radian,
-    double & max_radian);
-  int32_t ConvertRadianToValue(uint8_t id, double radian);
-  double ConvertValueToRadian(uint8_t id, int32_t value);
-  inline int16_t ConvertEffortToCurrent(uint8_t id, double effort)
-  {return static_cast<int16_t>(effort / dxl_info_[id].torque_constant);}
-  inline double ConvertCurrentToEffort(uint8_t id, int16_t current)
-  {return static_cast<double>(current * dxl_info_[id].torque_constant);}
-  inline double ConvertValueRPMToVelocityRPS(uint8_t id, int32_t value_rpm)
+    double & max_radian) const;
+  bool GetDxlTorqueConstant(uint8_t id, double & torque_constant) const;
+  int32_t ConvertRadianToValue(uint8_t id, double radian) const;
+  double ConvertValueToRadian(uint8_t id, int32_t value) const;
+  inline int16_t ConvertEffortToCurrent(uint8_t id, double effort) const
+  {
+    double torque_constant = 0.0;
+    GetDxlTorqueConstant(id, torque_constant);
+    return static_cast<int16_t>(effort / torque_constant);
+  }
+  inline double ConvertCurrentToEffort(uint8_t id, int16_t current) const
+  {
+    double torque_constant = 0.0;
+    GetDxlTorqueConstant(id, torque_constant);
+    return static_cast<double>(current * torque_constant);
+  }
+  inline double ConvertValueRPMToVelocityRPS(uint8_t id, int32_t value_rpm) const
   {return static_cast<double>(value_rpm * 0.01 / 60.0 * 2.0 * M_PI);}
-  inline int32_t ConvertVelocityRPSToValueRPM(uint8_t id, double vel_rps)
+  inline int32_t ConvertVelocityRPSToValueRPM(uint8_t id, double vel_rps) const
   {return static_cast<int32_t>(vel_rps * 100.0 * 60.0 / 2.0 / M_PI);}
+
+private:
+  // nullptr for unknown IDs, never inserts
+  const DxlInfo * FindDxlInfo(uint8_t id) const;
 };
 
 }  // namespace dynamixel_hardware_interface
@@ -17,8 +17,13 @@
 #ifndef DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL_HARDWARE_INTERFACE_HPP_
 #define DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL_HARDWARE_INTERFACE_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <map>
 
@@ -32,6 +37,12 @@
 
 #include "dynamixel_hardware_interface/visibility_control.h"
 #include "dynamixel_hardware_interface/dynamixel/dynamixel.hpp"
+#include "dynamixel_hardware_interface/handler_value_storage.hpp"
+#include "dynamixel_hardware_interface/latency_histogram.hpp"
+#include "dynamixel_hardware_interface/log_ring.hpp"
+#include "dynamixel_hardware_interface/snapshot_buffer.hpp"
+#include "dynamixel_hardware_interface/spsc_queue.hpp"
+#include "dynamixel_hardware_interface/transmission_matrix.hpp"
 
 #include "dynamixel_msgs/msg/dynamixel_state.hpp"
 #include "dynamixel_msgs/srv/get_data_from_dxl.hpp"
@@ -44,6 +55,8 @@
 
 #include "std_srvs/srv/set_bool.hpp"
 
+#include "diagnostic_msgs/msg/diagnostic_array.hpp"
+
 #define PRESENT_POSITION_INDEX 0
 #define PRESENT_VELOCITY_INDEX 1
 #define PRESENT_EFFORT_INDEX 2
@@ -65,7 +78,7 @@ namespace dynamixel_hardware_interface
     uint8_t id;                                /**< ID of the Dynamixel component. */
     std::string name;                          /**< Name of the component. */
     std::vector<std::string> interface_name_vec; /**< Vector of interface names. */
-    std::vector<std::shared_ptr<double>> value_ptr_vec; /**< Vector interface values. */
+    std::vector<double*> value_ptr_vec;        /**< Interface values, in a HandlerValueStorage. */
   } HandlerVarType;
 
   /**
@@ -90,6 +103,112 @@ namespace dynamixel_hardware_interface
     REQUESTED_TO_DISABLE = 3,  /**< Torque disable is requested. */
   } DxlTorqueStatus;
 
+  /**
+   * @brief Enum for the job a port thread runs in lockstep with read() / write().
+   */
+  typedef enum PortJob
+  {
+    PORT_JOB_NONE = 0,   /**< No job pending. */
+    PORT_JOB_READ = 1,   /**< Read states, sensors and the read item buffer. */
+    PORT_JOB_WRITE = 2,  /**< Write the write item buffer and commands. */
+    PORT_JOB_TORQUE = 3, /**< Carry out the torque change posted to the port, if any. */
+    PORT_JOB_EXIT = 4,   /**< Leave the thread. */
+  } PortJob;
+
+  /**
+   * @brief Enum for the service requests the executor thread hands to the control loop.
+   */
+  typedef enum ServiceRequestType
+  {
+    REQUEST_TORQUE = 0,     /**< Torque of every Dynamixel on or off. */
+    REQUEST_TORQUE_ID = 1,  /**< Torque of one Dynamixel on or off. */
+    REQUEST_REBOOT = 2,     /**< Hand the bus over to CommReset() on the executor thread. */
+  } ServiceRequestType;
+
+  /**
+   * @brief Struct for one service request, executor thread -> control loop.
+   */
+  typedef struct ServiceRequest_
+  {
+    uint32_t seq;             /**< Sequence number, echoed by the response. */
+    ServiceRequestType type;  /**< Request type. */
+    uint8_t id;               /**< Dynamixel ID, REQUEST_TORQUE_ID only. */
+    bool enable;              /**< Torque on or off. */
+  } ServiceRequest;
+
+  /**
+   * @brief Struct for one service response, control loop -> executor thread.
+   */
+  typedef struct ServiceResponse_
+  {
+    uint32_t seq;             /**< Sequence number of the request. */
+    bool result;              /**< Whether the request succeeded. */
+  } ServiceResponse;
+
+  /**
+   * @brief Enum for the phases of the read() / write() cycle with a latency histogram.
+   */
+  typedef enum LatencyPhase
+  {
+    LATENCY_READ_TXRX = 0,            /**< Bus round trip of the state read, per port. */
+    LATENCY_READ_DECODE = 1,          /**< Decoding of the state read, per port. */
+    LATENCY_READ_ITEM_BUF = 2,        /**< Buffered item reads, per port. */
+    LATENCY_BUS_WRITE = 3,            /**< Buffered item writes and the command write, per port. */
+    LATENCY_CALC_TRANS_TO_JOINT = 4,  /**< CalcTransmissionToJoint(). */
+    LATENCY_STATE_PUBLISH = 5,        /**< Sensor state copy and Dynamixel state publishing. */
+    LATENCY_SERVICE_REQUEST = 6,      /**< Service requests handed over by the executor thread. */
+    LATENCY_TORQUE_CHANGE = 7,        /**< ChangeDxlTorqueState(). */
+    LATENCY_CALC_JOINT_TO_TRANS = 8,  /**< CalcJointToTransmission(). */
+    LATENCY_READ = 9,                 /**< Whole read(). */
+    LATENCY_WRITE = 10,               /**< Whole write(). */
+    LATENCY_CYCLE = 11,               /**< Start of read() to end of write(), overruns the update period. */
+    LATENCY_PHASE_COUNT = 12,
+  } LatencyPhase;
+
+  /**
+   * @brief Struct for one serial port with its Dynamixel chain, handlers and bus thread.
+   */
+  typedef struct DxlPortType_
+  {
+    std::string port_name;                       /**< Serial port name. */
+    std::string baud_rate;                       /**< Baud rate of the port. */
+    std::string target_baud_rate;                /**< Baud rate to move the bus to at startup. */
+    int cpu{ -1 };                               /**< CPU the port thread is pinned to, -1 for none. */
+    std::shared_ptr<Dynamixel> dxl_comm;         /**< Communication object of the port. */
+    std::vector<uint8_t> dxl_id;                 /**< Dynamixel IDs on the port. */
+    std::vector<uint8_t> sensor_id;              /**< Sensor IDs on the port. */
+
+    std::vector<HandlerVarType> trans_states;        /**< Transmission states on the port. */
+    std::vector<HandlerVarType> trans_commands;      /**< Transmission commands on the port. */
+    std::vector<HandlerVarType> gpio_sensor_states;  /**< GPIO sensor states on the port. */
+    bool has_read_items{ false };                /**< States or sensors in the sync/bulk read. */
+
+    std::mutex mutex;                            /**< Guards dxl_comm while the port thread runs. */
+    std::thread thread;                          /**< Port thread. */
+    DxlError comm_err{ DxlError::OK };           /**< Result of the last bus read. */
+
+    std::mutex job_mutex;                        /**< Guards job. */
+    std::condition_variable job_cv;              /**< Signals job changes. */
+    PortJob job{ PORT_JOB_NONE };                /**< Lockstep job handed to the port thread. */
+
+    uint32_t torque_seq{ 0 };                    /**< Last torque change posted to the port. */
+    bool torque_enable{ false };                 /**< Torque of the last posted change. */
+    int torque_id{ -1 };                         /**< ID of the last posted change, -1 for all. */
+    uint32_t torque_done_seq{ 0 };               /**< Last torque change carried out on the port. */
+    bool torque_result{ false };                 /**< Result of the change torque_done_seq. */
+
+    std::atomic<bool> io_running{ false };       /**< Keeps the free running I/O loop alive. */
+    SnapshotBuffer state_buf;                    /**< I/O thread -> read() */
+    std::chrono::steady_clock::time_point state_stamp;  /**< Last fresh state_buf in read(). */
+    SnapshotBuffer command_buf;                  /**< write() -> I/O thread */
+    std::vector<HandlerVarType> io_trans_states;     /**< Values owned by the I/O thread. */
+    std::vector<HandlerVarType> io_trans_commands;   /**< Values owned by the I/O thread. */
+    std::vector<HandlerVarType> io_gpio_sensor_states; /**< Values owned by the I/O thread. */
+    HandlerValueStorage io_trans_state_values;       /**< Storage of io_trans_states. */
+    HandlerValueStorage io_trans_command_values;     /**< Storage of io_trans_commands. */
+    HandlerValueStorage io_gpio_sensor_state_values; /**< Storage of io_gpio_sensor_states. */
+  } DxlPortType;
+
   /**
    * @class DynamixelHardware
    * @brief Class for interfacing with Dynamixel hardware using the ROS2 hardware interface.
@@ -177,17 +296,61 @@ namespace dynamixel_hardware_interface
     rclcpp::Logger logger_;
 
     ///// dxl error
-    DxlStatus dxl_status_;
+    std::atomic<DxlStatus> dxl_status_;
     DxlError dxl_comm_err_;
-    std::map<uint8_t /*id*/, uint8_t /*err*/> dxl_hw_err_;
-    DxlTorqueStatus dxl_torque_status_;
+    std::vector<uint8_t> dxl_hw_err_;  /**< Hardware Error Status, one per transmission handler. */
+    std::atomic<DxlTorqueStatus> dxl_torque_status_;
     std::map<uint8_t /*id*/, bool /*enable*/> dxl_torque_state_;
+    bool torque_change_running_{ false };  /**< Posted to the ports, not carried out on all yet. */
     double err_timeout_ms_;
     rclcpp::Duration read_error_duration_{ 0, 0 };
     rclcpp::Duration write_error_duration_{ 0, 0 };
     bool is_read_in_error_{ false };
     bool is_write_in_error_{ false };
 
+    bool use_pipelined_read_{ false };
+
+    ///// port threads
+    bool use_io_thread_{ false };
+    double io_thread_rate_hz_{ 0.0 };
+    std::chrono::nanoseconds io_state_timeout_{ 0 };  /**< Oldest state snapshot read() takes. */
+    bool port_threads_running_{ false };
+
+    ///// latency statistics
+    bool use_latency_stats_{ false };
+    std::chrono::milliseconds latency_stats_period_{ 1000 };
+    LatencyHistogram latency_hist_[LATENCY_PHASE_COUNT];
+    std::chrono::steady_clock::time_point cycle_start_;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr latency_stats_pub_;
+    std::thread latency_stats_thread_;
+    std::mutex latency_stats_mutex_;
+    std::condition_variable latency_stats_cv_;
+    bool latency_stats_running_{ false };
+
+    ///// hot path logging
+    LogRing log_ring_;
+    std::thread log_thread_;
+    std::mutex log_mutex_;
+    std::condition_variable log_cv_;
+    bool log_running_{ false };
+
+    ///// service executor
+    static constexpr size_t SERVICE_QUEUE_SIZE = 64;
+    std::unique_ptr<rclcpp::executors::SingleThreadedExecutor> executor_;
+    std::thread executor_thread_;
+    std::atomic<bool> executor_running_{ false };
+    SpscQueue<ServiceRequest, SERVICE_QUEUE_SIZE> service_request_queue_;    /**< executor -> loop */
+    SpscQueue<ServiceResponse, SERVICE_QUEUE_SIZE> service_response_queue_;  /**< loop -> executor */
+    uint32_t service_seq_{ 0 };                    /**< Executor thread only. */
+    /** Request the caller still waits for. Whoever swaps it to 0 first, the control loop
+     *  starting it or the caller giving up on it, decides whether it runs. */
+    std::atomic<uint32_t> service_claim_seq_{ 0 };
+    ServiceRequest pending_request_;               /**< Control loop only. */
+    bool has_pending_request_{ false };            /**< Control loop only. */
+    std::chrono::steady_clock::time_point pending_request_deadline_;  /**< Control loop only. */
+    bool torque_id_posted_{ false };               /**< REQUEST_TORQUE_ID posted to its port. */
+    std::atomic<bool> comm_reset_running_{ false };  /**< read() / write() stay off the bus. */
+
     bool use_revolute_to_prismatic_{ false };
     std::string conversion_dxl_name_{ "" };
     std::string conversion_joint_name_{ "" };
@@ -223,13 +386,160 @@ namespace dynamixel_hardware_interface
      */
     bool CommReset();
 
+    /**
+     * @brief Starts one thread per port: free running I/O threads when use_io_thread is set,
+     * lockstep job threads when there is more than one port.
+     */
+    void StartPortThreads();
+
+    /**
+     * @brief Stops and joins the port threads.
+     */
+    void StopPortThreads();
+
+    /**
+     * @brief Lockstep port thread body. Runs the jobs posted by RunPortJobs().
+     * @param port The port of the thread.
+     */
+    void PortThreadLoop(DxlPortType& port);
+
+    /**
+     * @brief Free running I/O thread body. Runs the bus cycle and swaps snapshots with read()/write().
+     * @param port The port of the thread.
+     */
+    void IoThreadLoop(DxlPortType& port);
+
+    /**
+     * @brief Runs one bus job on a port. The caller holds the port mutex.
+     * @param port The port.
+     * @param job PORT_JOB_READ, PORT_JOB_WRITE or PORT_JOB_TORQUE.
+     * @return The communication result of the state read, OK for other jobs.
+     */
+    DxlError RunPortJob(DxlPortType& port, PortJob job);
+
+    /**
+     * @brief Runs a job on all ports concurrently and waits until every port has finished.
+     * @param job PORT_JOB_READ, PORT_JOB_WRITE or PORT_JOB_TORQUE.
+     */
+    void RunPortJobs(PortJob job);
+
+    /**
+     * @brief Reads the transmission states, from the bus or from the latest I/O thread snapshots.
+     * @return The first failed communication result over all ports, OK otherwise.
+     */
+    DxlError ReadDxlStates();
+
+    /**
+     * @brief Hands the transmission commands of a port over to its I/O thread.
+     * @param port The port.
+     * @param write_enable Whether the I/O thread may write them to the bus.
+     */
+    void PublishIoCommands(DxlPortType& port, bool write_enable);
+
+    /**
+     * @brief Posts a torque change to a port. Control loop only.
+     *
+     * Without I/O thread it is carried out by PORT_JOB_TORQUE in the next ChangeDxlTorqueState(),
+     * on the port thread if there is one. Otherwise it
+     * travels to the I/O thread with the command snapshots and is done once torque_done_seq
+     * catches up with torque_seq.
+     * @param port The port.
+     * @param enable Torque on or off.
+     * @param id The Dynamixel ID, -1 for every Dynamixel on the port.
+     */
+    void PostTorqueChange(DxlPortType& port, bool enable, int id);
+
+    /**
+     * @brief Writes a torque change to the bus. The caller holds the port mutex.
+     * @param port The port.
+     * @param enable Torque on or off.
+     * @param id The Dynamixel ID, -1 for every Dynamixel on the port.
+     * @return True if every write succeeded.
+     */
+    bool ChangePortTorque(DxlPortType& port, bool enable, int id);
+
+    /**
+     * @brief Records one latency sample when latency statistics are enabled.
+     * @param phase The cycle phase.
+     * @param since Start of the phase, moved to now for the next phase.
+     */
+    void RecordLatency(LatencyPhase phase, std::chrono::steady_clock::time_point& since);
+
+    /**
+     * @brief Starts the thread publishing the latency statistics.
+     */
+    void StartLatencyStats();
+
+    /**
+     * @brief Stops and joins the latency statistics thread.
+     */
+    void StopLatencyStats();
+
+    /**
+     * @brief Latency statistics thread body. Publishes and resets the histograms every period.
+     */
+    void LatencyStatsLoop();
+
+    /**
+     * @brief Starts the thread draining and printing the log ring.
+     */
+    void StartLogThread();
+
+    /**
+     * @brief Stops and joins the log thread, printing what is left in the ring.
+     */
+    void StopLogThread();
+
+    /**
+     * @brief Log thread body. Drains the log ring every LOG_DRAIN_PERIOD.
+     */
+    void LogThreadLoop();
+
+    /**
+     * @brief Prints the events in the log ring. Log thread only.
+     */
+    void DrainLogRing();
+
+    /**
+     * @brief Starts the thread spinning the node's services and publishers.
+     */
+    void StartExecutor();
+
+    /**
+     * @brief Stops and joins the executor thread.
+     */
+    void StopExecutor();
+
+    /**
+     * @brief Hands a request to the control loop and waits for its response. Executor thread only.
+     * @param type The request type.
+     * @param id The Dynamixel ID, REQUEST_TORQUE_ID only.
+     * @param enable Torque on or off.
+     * @param timeout How long to wait for the control loop.
+     * @return The result of the request, false on timeout or a full queue.
+     */
+    bool CallControlLoop(
+      ServiceRequestType type, uint8_t id, bool enable, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Runs at most one pending service request. Control loop only.
+     *
+     * A request that waits on the bus is retried in the next cycles. If it is not done by
+     * SERVICE_REQUEST_DEADLINE, it is answered with false so the requests behind it can run.
+     */
+    void ProcessServiceRequest();
+
+    /**
+     * @brief Finds the port a Dynamixel or sensor ID is on.
+     * @param id The ID.
+     * @return The port, or nullptr if the ID is unknown.
+     */
+    DxlPortType* GetPort(uint8_t id);
+
     ///// dxl variable
-    std::shared_ptr<Dynamixel> dxl_comm_;
-    std::string port_name_;
-    std::string baud_rate_;
-    std::vector<uint8_t> dxl_id_;
+    std::vector<std::unique_ptr<DxlPortType>> ports_;
+    std::map<uint8_t /*id*/, size_t /*port index*/> id_to_port_;
 
-    std::vector<uint8_t> sensor_id_;
     std::map<uint8_t /*id*/, std::string /*interface_name*/> sensor_item_;
 
     ///// handler variable
@@ -242,11 +552,29 @@ namespace dynamixel_hardware_interface
     std::vector<HandlerVarType> hdl_gpio_sensor_states_;
     std::vector<HandlerVarType> hdl_sensor_states_;
 
+    // contiguous values the handlers, the exported interfaces and the decode/encode plans point into
+    HandlerValueStorage trans_state_values_;
+    HandlerValueStorage trans_command_values_;
+    HandlerValueStorage joint_state_values_;
+    HandlerValueStorage joint_command_values_;
+    HandlerValueStorage gpio_sensor_state_values_;
+    HandlerValueStorage sensor_state_values_;
+
     // joint <-> transmission matrix
     size_t num_of_joints_;
     size_t num_of_transmissions_;
-    double** transmission_to_joint_matrix_;
-    double** joint_to_transmission_matrix_;
+    TransmissionMatrix transmission_to_joint_matrix_;
+    TransmissionMatrix joint_to_transmission_matrix_;
+    // handlers whose position goes through the revolute <-> prismatic conversion
+    std::vector<size_t> conversion_joint_index_;
+    std::vector<size_t> conversion_trans_index_;
+    // Hardware Error Status slots and the transmission handler of each, hardware_state slots
+    std::vector<size_t> hw_err_trans_index_;
+    std::vector<const double*> hw_err_value_;
+    std::vector<double*> hw_state_value_;
+    // GPIO sensor values read with the states and the exported sensor states they go to
+    std::vector<const double*> sensor_src_value_;
+    std::vector<double*> sensor_dst_value_;
 
     /**
      * @brief Initializes the Dynamixel items.
@@ -267,16 +595,33 @@ namespace dynamixel_hardware_interface
     bool InitDxlWriteItems();
 
     /**
-     * @brief Reads sensor data.
-     * @param sensor The sensor handler variable.
+     * @brief Gets the read_divisor parameter of a GPIO.
+     * @param gpio_name The GPIO name.
+     * @return The divisor, 1 if the GPIO has none.
+     */
+    uint32_t GetReadDivisor(const std::string& gpio_name);
+
+    /**
+     * @brief Pairs every GPIO sensor value with the exported sensor state it is copied to.
      */
-    void ReadSensorData(const HandlerVarType& sensor);
+    void SetSensorIndex();
 
     ///// function
     /**
      * @brief Sets up the joint-to-transmission and transmission-to-joint matrices.
+     * @return True if both matrices have number_of_joints x number_of_transmissions values.
+     */
+    bool SetMatrix();
+
+    /**
+     * @brief Finds the handlers named by the revolute to prismatic conversion parameters.
+     */
+    void SetConversionIndex();
+
+    /**
+     * @brief Finds the Hardware Error Status and hardware_state slots checked by CheckError().
      */
-    void SetMatrix();
+    void SetErrorIndex();
 
     /**
      * @brief Calculates the joint states from transmission states.
@@ -0,0 +1,95 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__HANDLER_VALUE_STORAGE_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__HANDLER_VALUE_STORAGE_HPP_
+
+#include <stdlib.h>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @class HandlerValueStorage
+ * @brief Cache-line aligned structure-of-arrays storage for the values of a handler group.
+ *
+ * Value j of handler i lives at Column(j)[i], so one interface (e.g. position) of every
+ * handler is contiguous and every column starts on its own cache line.
+ */
+class HandlerValueStorage
+{
+public:
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  HandlerValueStorage()
+  : handler_cnt_(0), column_cnt_(0), stride_(0) {}
+
+  /**
+   * @brief Allocates zeroed storage. Pointers of a previous layout become invalid.
+   * @param value_cnt Number of values of every handler.
+   */
+  void Allocate(const std::vector<size_t> & value_cnt)
+  {
+    handler_cnt_ = value_cnt.size();
+    column_cnt_ = 0;
+    for (auto cnt : value_cnt) {
+      column_cnt_ = cnt > column_cnt_ ? cnt : column_cnt_;
+    }
+    const size_t doubles_per_line = CACHE_LINE_SIZE / sizeof(double);
+    stride_ = (handler_cnt_ + doubles_per_line - 1) / doubles_per_line * doubles_per_line;
+
+    data_.reset();
+    size_t bytes = stride_ * column_cnt_ * sizeof(double);
+    if (bytes == 0) {
+      return;
+    }
+    void * data = nullptr;
+    if (posix_memalign(&data, CACHE_LINE_SIZE, bytes) != 0) {
+      throw std::bad_alloc();
+    }
+    std::memset(data, 0, bytes);
+    data_.reset(static_cast<double *>(data));
+  }
+
+  /**
+   * @brief Values of column index, one per handler.
+   */
+  double * Column(size_t index) const {return data_.get() + index * stride_;}
+
+  size_t HandlerCount() const {return handler_cnt_;}
+  size_t ColumnCount() const {return column_cnt_;}
+
+private:
+  struct Free
+  {
+    void operator()(double * data) const {free(data);}
+  };
+
+  std::unique_ptr<double, Free> data_;
+  size_t handler_cnt_;
+  size_t column_cnt_;
+  size_t stride_;  // doubles between two columns, a multiple of the cache line
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__HANDLER_VALUE_STORAGE_HPP_
@@ -0,0 +1,164 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__LATENCY_HISTOGRAM_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__LATENCY_HISTOGRAM_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @brief Statistics of one LatencyHistogram period.
+ */
+typedef struct LatencyStats_
+{
+  uint64_t count;     ///< Number of samples.
+  uint64_t p50_ns;    ///< Median, upper bound of its bucket.
+  uint64_t p99_ns;    ///< 99th percentile, upper bound of its bucket.
+  uint64_t max_ns;    ///< Largest sample.
+  uint64_t overruns;  ///< Samples above the budget.
+} LatencyStats;
+
+/**
+ * @class LatencyHistogram
+ * @brief Lock-free log-linear latency histogram in nanoseconds.
+ *
+ * Every power of two is split into 8 linear buckets (HDR style), so a bucket is at most
+ * 12.5 % wide over the whole 64 bit range. Record() is wait-free and may be called from
+ * several threads. TakeStats() is meant for one non real-time reader and resets the histogram.
+ */
+class LatencyHistogram
+{
+public:
+  LatencyHistogram()
+  : budget_ns_(0)
+  {
+    for (auto & bucket : bucket_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+    max_ns_.store(0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Sets the budget samples are counted as overruns above. 0 disables it.
+   * Must not be called while Record() runs.
+   */
+  void SetBudget(uint64_t budget_ns) {budget_ns_ = budget_ns;}
+
+  /**
+   * @brief Records one sample.
+   * @param ns Latency in nanoseconds. Negative values count as 0.
+   */
+  void Record(int64_t ns)
+  {
+    uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    bucket_[Index(value)].fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t max = max_ns_.load(std::memory_order_relaxed);
+    while (value > max &&
+      !max_ns_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+
+    if (budget_ns_ > 0 && value > budget_ns_) {
+      overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Computes the statistics since the last call and resets the histogram.
+   * @param stats Filled with the statistics.
+   */
+  void TakeStats(LatencyStats & stats)
+  {
+    uint64_t count[BUCKET_COUNT];
+    stats.count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      count[i] = bucket_[i].exchange(0, std::memory_order_relaxed);
+      stats.count += count[i];
+    }
+    stats.max_ns = max_ns_.exchange(0, std::memory_order_relaxed);
+    stats.overruns = overruns_.exchange(0, std::memory_order_relaxed);
+    stats.p50_ns = Percentile(count, stats.count, 0.50, stats.max_ns);
+    stats.p99_ns = Percentile(count, stats.count, 0.99, stats.max_ns);
+  }
+
+private:
+  enum : size_t
+  {
+    SUB_BUCKET_BITS = 3,
+    SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+    BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT
+  };
+
+  static size_t Msb(uint64_t value)
+  {
+    size_t msb = 0;
+    while (value >>= 1) {
+      msb++;
+    }
+    return msb;
+  }
+
+  static size_t Index(uint64_t value)
+  {
+    if (value < SUB_BUCKET_COUNT) {
+      return static_cast<size_t>(value);
+    }
+    size_t shift = Msb(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+  }
+
+  static uint64_t UpperBound(size_t index)
+  {
+    if (index < SUB_BUCKET_COUNT) {
+      return index;
+    }
+    size_t shift = index / SUB_BUCKET_COUNT - 1;
+    uint64_t sub = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  static uint64_t Percentile(
+    const uint64_t * count, uint64_t total, double quantile, uint64_t max_ns)
+  {
+    if (total == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+      seen += count[i];
+      if (seen >= rank) {
+        uint64_t bound = UpperBound(i);
+        return bound < max_ns ? bound : max_ns;
+      }
+    }
+    return max_ns;
+  }
+
+  uint64_t budget_ns_;
+  std::atomic<uint64_t> bucket_[BUCKET_COUNT];
+  std::atomic<uint64_t> max_ns_;
+  std::atomic<uint64_t> overruns_;
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__LATENCY_HISTOGRAM_HPP_
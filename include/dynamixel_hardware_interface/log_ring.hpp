@@ -0,0 +1,188 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__LOG_RING_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__LOG_RING_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @brief Enum for the events logged from the control loop and the bus threads.
+ */
+typedef enum LogEventCode
+{
+  LOG_READ_REQUEST_FAIL = 0,       /**< value: SDK comm result. */
+  LOG_SYNC_READ_FAIL = 1,          /**< value: SDK comm result, aux: 1 for fast sync read. */
+  LOG_BULK_READ_FAIL = 2,          /**< value: SDK comm result, aux: 1 for fast bulk read. */
+  LOG_SYNC_WRITE_FAIL = 3,         /**< value: SDK comm result. */
+  LOG_BULK_WRITE_FAIL = 4,         /**< value: SDK comm result. */
+  LOG_ITEM_READ_COMM_FAIL = 5,     /**< id, value: SDK comm result. */
+  LOG_ITEM_READ_PACKET_ERROR = 6,  /**< id, value: status packet error. */
+  LOG_COMM_FAIL = 7,               /**< value: DxlError. */
+  LOG_HW_ERROR = 8,                /**< id, value: Hardware Error Status. */
+  LOG_READ_FAIL = 9,               /**< value: error duration [ms], aux: error timeout [ms]. */
+  LOG_STATE_READ_FAIL = 10,        /**< value: DxlError, read while in hardware error. */
+  LOG_WRITE_FAIL = 11,             /**< value: error duration [ms], aux: error timeout [ms]. */
+  LOG_SENSOR_READ_FAIL = 12,       /**< value: SDK comm result, aux: read divisor of the sensors. */
+  LOG_EVENT_CODE_COUNT = 13
+} LogEventCode;
+
+/**
+ * @brief Struct for one logged event, formatted later by the drain thread.
+ */
+typedef struct LogEvent
+{
+  LogEventCode code;    ///< What happened.
+  uint8_t id;           ///< Dynamixel ID, 0 if not bound to one.
+  int64_t value;        ///< Event specific, see LogEventCode.
+  int64_t aux;          ///< Event specific, see LogEventCode.
+  uint64_t suppressed;  ///< Same code and ID events dropped by the rate limit since the last.
+  int64_t stamp_ns;     ///< steady_clock time of the event.
+} LogEvent;
+
+/**
+ * @class LogRing
+ * @brief Preallocated lock-free multi producer / single consumer ring of log events.
+ *
+ * Log() never allocates, formats or blocks, so it is safe in read() / write() and in the port
+ * threads. Every event code and ID is rate limited on its own: within the interval after a
+ * logged event, further events of that code and ID are only counted and the count rides along
+ * with the next logged one, so a fault on one Dynamixel never hides one on another. A full ring
+ * drops the event and counts it. The cell sequence numbers follow Dmitry Vyukov's bounded MPMC
+ * queue, with a single consumer.
+ */
+class LogRing
+{
+public:
+  static constexpr size_t CAPACITY = 256;
+  static constexpr size_t ID_COUNT = 256;
+
+  LogRing()
+  : interval_ns_(0), tail_(0), head_(0), dropped_(0)
+  {
+    for (size_t i = 0; i < CAPACITY; i++) {
+      cell_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < LOG_EVENT_CODE_COUNT; i++) {
+      for (size_t id = 0; id < ID_COUNT; id++) {
+        last_ns_[i][id].store(std::numeric_limits<int64_t>::min() / 2, std::memory_order_relaxed);
+        suppressed_[i][id].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief Sets the minimum time between two logged events of the same code and ID, 0 logs all.
+   */
+  void SetInterval(std::chrono::nanoseconds interval)
+  {
+    interval_ns_.store(interval.count(), std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Logs an event unless its code and ID are rate limited or the ring is full. Any thread.
+   * @return False if the event was suppressed or dropped.
+   */
+  bool Log(LogEventCode code, uint8_t id = 0, int64_t value = 0, int64_t aux = 0)
+  {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::atomic<int64_t> & last_ns = last_ns_[code][id];
+    int64_t last = last_ns.load(std::memory_order_relaxed);
+    if (now - last < interval_ns_.load(std::memory_order_relaxed) ||
+      !last_ns.compare_exchange_strong(last, now, std::memory_order_relaxed))
+    {
+      suppressed_[code][id].fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell * cell;
+    while (true) {
+      cell = &cell_[pos & (CAPACITY - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->event.code = code;
+    cell->event.id = id;
+    cell->event.value = value;
+    cell->event.aux = aux;
+    cell->event.suppressed = suppressed_[code][id].exchange(0, std::memory_order_relaxed);
+    cell->event.stamp_ns = now;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Takes the oldest event. Consumer only.
+   * @return False if the ring is empty.
+   */
+  bool Pop(LogEvent & event)
+  {
+    Cell & cell = cell_[head_ & (CAPACITY - 1)];
+    if (cell.seq.load(std::memory_order_acquire) != head_ + 1) {
+      return false;
+    }
+    event = cell.event;
+    cell.seq.store(head_ + CAPACITY, std::memory_order_release);
+    head_++;
+    return true;
+  }
+
+  /**
+   * @brief Events dropped on a full ring since the last call.
+   */
+  uint64_t TakeDropped() {return dropped_.exchange(0, std::memory_order_relaxed);}
+
+private:
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY is a power of two");
+
+  struct Cell
+  {
+    std::atomic<size_t> seq;  // pos: free for push pos, pos + 1: holds the event of push pos
+    LogEvent event;
+  };
+
+  Cell cell_[CAPACITY];
+  std::atomic<int64_t> interval_ns_;
+  std::atomic<int64_t> last_ns_[LOG_EVENT_CODE_COUNT][ID_COUNT];
+  std::atomic<uint64_t> suppressed_[LOG_EVENT_CODE_COUNT][ID_COUNT];
+  std::atomic<size_t> tail_;   // next push position, shared by the producers
+  size_t head_;                // next pop position, consumer only
+  std::atomic<uint64_t> dropped_;
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__LOG_RING_HPP_
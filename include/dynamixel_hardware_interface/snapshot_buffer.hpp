@@ -0,0 +1,102 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__SNAPSHOT_BUFFER_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__SNAPSHOT_BUFFER_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @class SnapshotBuffer
+ * @brief Wait-free single producer / single consumer buffer handing over the latest snapshot.
+ *
+ * Three slots rotate through one atomic index, so neither side ever blocks.
+ * The producer fills Back() and calls Publish(). The consumer calls Fetch() and reads Front(),
+ * which stays valid until its next Fetch().
+ */
+class SnapshotBuffer
+{
+public:
+  SnapshotBuffer()
+  : back_(0), middle_(1), front_(2) {}
+
+  /**
+   * @brief Sizes all slots. Must not be called while the buffer is in use.
+   * @param size Number of values in one snapshot.
+   */
+  void Init(size_t size)
+  {
+    for (auto & slot : slot_) {
+      slot.assign(size, 0.0);
+    }
+    back_ = 0;
+    middle_.store(1);
+    front_ = 2;
+  }
+
+  /**
+   * @brief Slot owned by the producer.
+   */
+  std::vector<double> & Back() {return slot_[back_];}
+
+  /**
+   * @brief Hands the producer slot over to the consumer.
+   */
+  void Publish()
+  {
+    back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+  }
+
+  /**
+   * @brief Takes the latest published snapshot, if any.
+   * @return True if Front() now holds a newer snapshot.
+   */
+  bool Fetch()
+  {
+    if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0) {
+      return false;
+    }
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   * @brief Slot owned by the consumer.
+   */
+  const std::vector<double> & Front() const {return slot_[front_];}
+
+private:
+  enum : uint8_t
+  {
+    INDEX_MASK = 0x03,
+    FRESH = 0x04
+  };
+
+  std::vector<double> slot_[3];
+  uint8_t back_;
+  std::atomic<uint8_t> middle_;
+  uint8_t front_;
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__SNAPSHOT_BUFFER_HPP_
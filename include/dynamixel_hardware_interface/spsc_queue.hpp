@@ -0,0 +1,81 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__SPSC_QUEUE_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__SPSC_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @class SpscQueue
+ * @brief Bounded wait-free single producer / single consumer queue.
+ *
+ * Holds up to CAPACITY - 1 elements in a preallocated ring, so neither Push() nor Pop()
+ * allocates or blocks. T is copied in and out and should be small and trivially copyable.
+ */
+template<typename T, size_t CAPACITY>
+class SpscQueue
+{
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY is a power of two");
+
+public:
+  SpscQueue()
+  : head_(0), tail_(0) {}
+
+  /**
+   * @brief Appends an element. Producer only.
+   * @return False if the queue is full.
+   */
+  bool Push(const T & value)
+  {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) & (CAPACITY - 1);
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slot_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Takes the oldest element. Consumer only.
+   * @return False if the queue is empty.
+   */
+  bool Pop(T & value)
+  {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    value = slot_[head];
+    head_.store((head + 1) & (CAPACITY - 1), std::memory_order_release);
+    return true;
+  }
+
+private:
+  T slot_[CAPACITY];
+  std::atomic<size_t> head_;  // next slot to pop, written by the consumer
+  std::atomic<size_t> tail_;  // next slot to push, written by the producer
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__SPSC_QUEUE_HPP_
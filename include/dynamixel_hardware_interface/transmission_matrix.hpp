@@ -0,0 +1,95 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#ifndef DYNAMIXEL_HARDWARE_INTERFACE__TRANSMISSION_MATRIX_HPP_
+#define DYNAMIXEL_HARDWARE_INTERFACE__TRANSMISSION_MATRIX_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "dynamixel_hardware_interface/handler_value_storage.hpp"
+
+namespace dynamixel_hardware_interface
+{
+
+/**
+ * @class TransmissionMatrix
+ * @brief Joint <-> transmission matrix, analyzed once into the cheapest form to apply it with.
+ *
+ * Apply() maps up to MAX_VECTOR_CNT vectors (position, velocity, effort) in a single pass
+ * over the matrix. The dense kernel walks the matrix column by column (axpy), which keeps
+ * the inner loop free of dependencies so the compiler can vectorize it.
+ */
+class TransmissionMatrix
+{
+public:
+  typedef enum Form
+  {
+    IDENTITY = 0,     /**< Square identity, a copy. */
+    PERMUTATION = 1,  /**< One nonzero in every row (permutation, gear ratios). */
+    SPARSE = 2,       /**< At most half of the entries nonzero, CSR. */
+    DENSE = 3,        /**< Column-major, cache-line aligned. */
+  } Form;
+
+  static constexpr size_t MAX_VECTOR_CNT = 3;
+
+  TransmissionMatrix();
+
+  /**
+   * @brief Sets the matrix and picks its form.
+   * @param rows Number of rows (outputs).
+   * @param cols Number of columns (inputs).
+   * @param values rows x cols values, row-major.
+   * @return False if values does not hold rows x cols values.
+   */
+  bool Set(size_t rows, size_t cols, const std::vector<double> & values);
+
+  /**
+   * @brief Computes out[k][i] = sum_j M[i][j] * in[k][j] for every k < vector_cnt.
+   * @param in vector_cnt input vectors of Cols() values.
+   * @param out vector_cnt output vectors of Rows() values, not overlapping any input.
+   * @param vector_cnt Number of vectors, at most MAX_VECTOR_CNT.
+   */
+  void Apply(const double * const * in, double * const * out, size_t vector_cnt) const;
+
+  double At(size_t row, size_t col) const {return value_.at(row * cols_ + col);}
+  size_t Rows() const {return rows_;}
+  size_t Cols() const {return cols_;}
+  Form GetForm() const {return form_;}
+  static const char * FormToString(Form form);
+
+private:
+  size_t rows_;
+  size_t cols_;
+  Form form_;
+  std::vector<double> value_;  // row-major, as set
+
+  // PERMUTATION: out[i] = scale_[i] * in[index_[i]]
+  std::vector<size_t> index_;
+  std::vector<double> scale_;
+
+  // SPARSE: nonzeros of row i are [row_begin_[i], row_begin_[i + 1])
+  std::vector<size_t> row_begin_;
+  std::vector<size_t> col_;
+  std::vector<double> nonzero_;
+
+  // DENSE: dense_.Column(j)[i] = M[i][j]
+  HandlerValueStorage dense_;
+};
+
+}  // namespace dynamixel_hardware_interface
+
+#endif  // DYNAMIXEL_HARDWARE_INTERFACE__TRANSMISSION_MATRIX_HPP_
@@ -0,0 +1,142 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+// Converts text .model files into the formats loaded by DynamixelInfo.
+// Usage: dxl_model_converter <input.model> <output.model.bin>
+//        dxl_model_converter --header <model folder> <output.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dynamixel_hardware_interface/dynamixel/dynamixel_info.hpp"
+
+using dynamixel_hardware_interface::DxlInfo;
+using dynamixel_hardware_interface::DynamixelInfo;
+
+namespace
+{
+std::string ToLiteral(const std::string & str)
+{
+  std::string literal = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      literal += '\\';
+    }
+    literal += c;
+  }
+  return literal + "\"";
+}
+
+std::string ToDouble(double value)
+{
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.17g", value);
+  return buf;
+}
+
+// constexpr control tables of every model in the model list of the folder
+bool WriteModelHeader(const std::string & model_folder, const std::string & out_path)
+{
+  std::ifstream list_file(model_folder + "/dynamixel.model");
+  if (!list_file.is_open()) {
+    fprintf(stderr, "[ERROR] CANNOT FIND DXL MODEL LIST FILE [%s].\n", model_folder.c_str());
+    return false;
+  }
+  std::string line;
+  getline(list_file, line);
+
+  std::vector<std::pair<uint16_t, DxlInfo>> models;
+  while (!list_file.eof()) {
+    uint16_t model_number;
+    std::string file_name;
+    list_file >> model_number >> file_name;
+    if (!list_file.good()) {
+      break;
+    }
+    DxlInfo dxl_info = DxlInfo();
+    if (!DynamixelInfo::ReadDxlModelText(model_folder + "/" + file_name, dxl_info)) {
+      fprintf(stderr, "[ERROR] CANNOT READ DXL MODEL FILE [%s].\n", file_name.c_str());
+      return false;
+    }
+    models.push_back(std::make_pair(model_number, dxl_info));
+  }
+
+  std::ofstream out(out_path, std::ios::trunc);
+  if (!out.is_open()) {
+    return false;
+  }
+  out << "// Generated by dxl_model_converter from param/dxl_model. Do not edit.\n\n";
+  out << "#ifndef DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL__DXL_BUILTIN_MODEL_TABLE_HPP_\n";
+  out << "#define DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL__DXL_BUILTIN_MODEL_TABLE_HPP_\n\n";
+  out << "#include \"dynamixel_hardware_interface/dynamixel/dynamixel_info.hpp\"\n\n";
+  out << "namespace dynamixel_hardware_interface\n{\n\n";
+
+  for (size_t i = 0; i < models.size(); i++) {
+    out << "constexpr BuiltinControlItem BUILTIN_DXL_MODEL_" << models[i].first << "_ITEM[] =\n{\n";
+    for (const auto & item : models[i].second.item) {
+      out << "  {" << item.address << ", " << static_cast<int>(item.size) << ", " <<
+        ToLiteral(item.item_name) << "},\n";
+    }
+    if (models[i].second.item.empty()) {
+      out << "  {0, 0, \"\"},\n";
+    }
+    out << "};\n\n";
+  }
+
+  out << "constexpr BuiltinDxlModel BUILTIN_DXL_MODEL[] =\n{\n";
+  for (const auto & model : models) {
+    const DxlInfo & info = model.second;
+    out << "  {" << model.first << ", " << ToDouble(info.torque_constant) << ", " <<
+      ToDouble(info.min_radian) << ", " << ToDouble(info.max_radian) << ", " <<
+      info.value_of_zero_radian_position << ", " << info.value_of_max_radian_position << ", " <<
+      info.value_of_min_radian_position << ", BUILTIN_DXL_MODEL_" << model.first << "_ITEM, " <<
+      info.item.size() << "},\n";
+  }
+  // keeps the array non-empty, not counted
+  out << "  {0, 0.0, 0.0, 0.0, 0, 0, 0, nullptr, 0},\n";
+  out << "};\n\n";
+  out << "constexpr size_t BUILTIN_DXL_MODEL_CNT = " << models.size() << ";\n\n";
+  out << "}  // namespace dynamixel_hardware_interface\n\n";
+  out << "#endif  // DYNAMIXEL_HARDWARE_INTERFACE__DYNAMIXEL__DXL_BUILTIN_MODEL_TABLE_HPP_\n";
+  return out.good();
+}
+}  // namespace
+
+int main(int argc, char ** argv)
+{
+  if (argc == 4 && std::string(argv[1]) == "--header") {
+    return WriteModelHeader(argv[2], argv[3]) ? 0 : 1;
+  }
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s <input.model> <output.model.bin>\n", argv[0]);
+    fprintf(stderr, "       %s --header <model folder> <output.hpp>\n", argv[0]);
+    return 1;
+  }
+
+  DxlInfo dxl_info = DxlInfo();
+  if (!DynamixelInfo::ReadDxlModelText(argv[1], dxl_info)) {
+    fprintf(stderr, "[ERROR] CANNOT READ DXL MODEL FILE [%s].\n", argv[1]);
+    return 1;
+  }
+  if (!DynamixelInfo::WriteDxlModelBinary(argv[2], dxl_info)) {
+    fprintf(stderr, "[ERROR] CANNOT WRITE DXL MODEL BINARY [%s].\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
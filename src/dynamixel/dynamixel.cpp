@@ -16,6 +16,9 @@
 
 #include "dynamixel_hardware_interface/dynamixel/dynamixel.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <queue>
 #include <vector>
 #include <string>
@@ -24,8 +27,41 @@
 namespace dynamixel_hardware_interface
 {
 
+// "Baud Rate" control item value -> baud rate (Protocol 2.0 models)
+static const int BAUD_RATE_TABLE[] =
+{9600, 57600, 115200, 1000000, 2000000, 3000000, 4000000, 4500000};
+
+// parameter bytes of one indirect address sync write, keeps the packet in the SDK tx buffer
+static const size_t INDIRECT_ADDR_SYNC_WRITE_MAX_PARAM = 1000;
+
+// longest read schedule, the least common multiple of the read divisors of a port
+static const size_t READ_SCHEDULE_MAX_CYCLE = 10000;
+
+static size_t Gcd(size_t a, size_t b)
+{
+  while (b != 0) {
+    size_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
 Dynamixel::Dynamixel(const char * path)
+: read_cycle_(0),
+  active_read_(nullptr),
+  sensor_read_cycle_(0),
+  use_fast_read_(false)
 {
+  read_requested_ = false;
+  read_txrx_ns_ = 0;
+  read_decode_ns_ = 0;
+  use_write_elision_ = false;
+  write_deadband_ = 0;
+  write_refresh_cycles_ = 0;
+  write_header_size_ = 0;
+  log_ring_ = nullptr;
+
   dxl_info_.SetDxlModelFolderPath(path);
   dxl_info_.InitDxlModelInfo();
 
@@ -35,6 +71,8 @@ Dynamixel::Dynamixel(const char * path)
 
 Dynamixel::~Dynamixel()
 {
+  ClearReadGroups();
+  ClearSensorReadGroups();
   port_handler_->closePort();
   fprintf(stderr, "closed port\n");
 }
@@ -44,6 +82,7 @@ DxlError Dynamixel::InitDxlComm(
   std::string port_name,
   std::string baudrate)
 {
+  read_requested_ = false;
   port_handler_ = dynamixel::PortHandler::getPortHandler(port_name.c_str());  // port name
   packet_handler_ = dynamixel::PacketHandler::getPacketHandler();
 
@@ -61,6 +100,95 @@ DxlError Dynamixel::InitDxlComm(
     return DxlError::OPEN_PORT_FAIL;
   }
 
+  std::map<uint8_t, uint16_t> model_num;
+  DxlError result = DiscoverDxl(id_arr, model_num);
+  if (result != DxlError::OK) {
+    return result;
+  }
+  for (auto it_id : id_arr) {
+    dxl_info_.ReadDxlModelFile(it_id, model_num[it_id]);
+  }
+
+  ClearReadGroups();
+  ClearSensorReadGroups();
+  read_data_list_.clear();
+  sensor_read_data_list_.clear();
+  write_data_list_.clear();
+  write_encode_plan_.clear();
+  write_blocks_.clear();
+
+  for (auto it_id : id_arr) {
+    if (dxl_info_.CheckDxlControlItem(it_id, "Torque Enable")) {
+      torque_state_[it_id] = TORQUE_OFF;
+    }
+  }
+
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::DiscoverDxl(
+  const std::vector<uint8_t> & id_arr, std::map<uint8_t, uint16_t> & model_num)
+{
+  // one broadcast ping finds every ID on the bus
+  std::vector<uint8_t> found_id;
+  int dxl_comm_result = packet_handler_->broadcastPing(port_handler_, found_id);
+  if (dxl_comm_result == COMM_NOT_AVAILABLE) {
+    // Protocol 1.0 has no broadcast ping
+    return PingDxl(id_arr, model_num);
+  }
+  if (found_id.empty()) {
+    fprintf(
+      stderr, "Broadcast ping : no Dynamixel answered - %s\n",
+      packet_handler_->getTxRxResult(dxl_comm_result));
+    return DxlError::CANNOT_FIND_CONTROL_ITEM;
+  }
+
+  std::string missing_id;
+  for (auto it_id : id_arr) {
+    if (std::find(found_id.begin(), found_id.end(), it_id) == found_id.end()) {
+      missing_id += " " + std::to_string(it_id);
+    }
+  }
+  fprintf(stderr, "Broadcast ping : %zu Dynamixel found\n", found_id.size());
+  if (!missing_id.empty()) {
+    fprintf(stderr, "Broadcast ping : missing ID :%s\n", missing_id.c_str());
+    return DxlError::DXL_NOT_FOUND;
+  }
+
+  // model numbers of all IDs in one sync read of "Model Number" (address 0, 2 bytes)
+  dynamixel::GroupSyncRead model_read(port_handler_, packet_handler_, 0, 2);
+  for (auto it_id : id_arr) {
+    model_read.addParam(it_id);
+  }
+  dxl_comm_result = model_read.txRxPacket();
+  if (dxl_comm_result != COMM_SUCCESS) {
+    fprintf(
+      stderr, "Model number SyncRead Fail - %s, ping one by one\n",
+      packet_handler_->getTxRxResult(dxl_comm_result));
+    return PingDxl(id_arr, model_num);
+  }
+
+  for (auto it_id : id_arr) {
+    uint8_t dxl_error = 0;
+    model_read.getError(it_id, &dxl_error);
+    if (dxl_error != 0) {
+      fprintf(
+        stderr, "[ID:%03d] RX_PACKET_ERROR : %s\n", it_id,
+        packet_handler_->getRxPacketError(dxl_error));
+      uint32_t err = 0;
+      ReadItem(it_id, "Hardware Error Status", err);
+      fprintf(stderr, "Read Hardware Error Status : %x\n", err);
+      return DxlError::CANNOT_FIND_CONTROL_ITEM;
+    }
+    model_num[it_id] = static_cast<uint16_t>(model_read.getData(it_id, 0, 2));
+    fprintf(stderr, "[ID:%03d] Dynamixel model number : %d\n", it_id, model_num[it_id]);
+  }
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::PingDxl(
+  const std::vector<uint8_t> & id_arr, std::map<uint8_t, uint16_t> & model_num)
+{
   uint16_t dxl_model_number;
   uint8_t dxl_error = 0;
 
@@ -80,25 +208,15 @@ DxlError Dynamixel::InitDxlComm(
     } else {
       fprintf(stderr, " - Ping succeeded. Dynamixel model number : %d\n", dxl_model_number);
     }
-
-    dxl_info_.ReadDxlModelFile(it_id, dxl_model_number);
-  }
-
-  read_data_list_.clear();
-  write_data_list_.clear();
-
-  for (auto it_id : id_arr) {
-    if (dxl_info_.CheckDxlControlItem(it_id, "Torque Enable")) {
-      torque_state_[it_id] = TORQUE_OFF;
-    }
+    model_num[it_id] = dxl_model_number;
   }
-
   return DxlError::OK;
 }
 
 DxlError Dynamixel::Reboot(uint8_t id)
 {
   fprintf(stderr, "[ID:%03d] Rebooting...\n", id);
+  FinishReadRequest();
   uint8_t dxl_error = 0;
 
   int dxl_comm_result = packet_handler_->reboot(port_handler_, id, &dxl_error);
@@ -120,16 +238,157 @@ DxlError Dynamixel::Reboot(uint8_t id)
   return DxlError::OK;
 }
 
+DxlError Dynamixel::OptimizeBusTiming(
+  std::vector<uint8_t> id_arr, int target_baudrate, std::vector<uint8_t> & fail_id_arr)
+{
+  FinishReadRequest();
+  fail_id_arr.clear();
+
+  int current_baudrate = port_handler_->getBaudRate();
+  int target_code = -1;
+  if (target_baudrate > 0 && target_baudrate != current_baudrate) {
+    for (size_t code = 0; code < sizeof(BAUD_RATE_TABLE) / sizeof(BAUD_RATE_TABLE[0]); code++) {
+      if (BAUD_RATE_TABLE[code] == target_baudrate) {
+        target_code = static_cast<int>(code);
+      }
+    }
+    if (target_code < 0) {
+      fprintf(stderr, "Unsupported target baudrate [%d]\n", target_baudrate);
+      return DxlError::BUS_TIMING_FAIL;
+    }
+  }
+
+  // read everything first, only the IDs that need an EEPROM write lose their torque below
+  std::map<uint8_t, uint32_t> prev_code;
+  std::map<uint8_t, uint32_t> prev_delay;
+  for (auto it_id : id_arr) {
+    if (target_code >= 0 && dxl_info_.CheckDxlControlItem(it_id, "Baud Rate")) {
+      uint32_t code = 0;
+      if (ReadItem(it_id, "Baud Rate", code) != DxlError::OK) {
+        fprintf(stderr, "[ID:%03d] Cannot read the baud rate, keep [%d]\n", it_id, current_baudrate);
+        return DxlError::BUS_TIMING_FAIL;
+      }
+      if (code != static_cast<uint32_t>(target_code)) {
+        prev_code[it_id] = code;
+      }
+    }
+    if (dxl_info_.CheckDxlControlItem(it_id, "Return Delay Time")) {
+      uint32_t delay = 0;
+      if (ReadItem(it_id, "Return Delay Time", delay) != DxlError::OK) {
+        fprintf(stderr, "[ID:%03d] Cannot read the Return Delay Time\n", it_id);
+        fail_id_arr.push_back(it_id);
+      } else if (delay != 0) {
+        prev_delay[it_id] = delay;
+      }
+    }
+  }
+
+  // Baud Rate and Return Delay Time are EEPROM items, writable with torque off only.
+  // torque_state_ starts as off, so torque a previous run left on is switched off explicitly.
+  for (auto it_id : id_arr) {
+    if (!prev_code.count(it_id) && !prev_delay.count(it_id)) {
+      continue;
+    }
+    if (!dxl_info_.CheckDxlControlItem(it_id, "Torque Enable")) {
+      continue;
+    }
+    if (WriteItem(it_id, "Torque Enable", TORQUE_OFF) != DxlError::OK) {
+      fprintf(stderr, "[ID:%03d] Cannot write \"Torque Off\" command!\n", it_id);
+      fail_id_arr.push_back(it_id);
+      return DxlError::BUS_TIMING_FAIL;
+    }
+    torque_state_[it_id] = TORQUE_OFF;
+  }
+
+  if (!prev_code.empty()) {
+    // the status packet still comes back at the current baud rate,
+    // whether every servo switched is checked by the ping sweep below
+    bool write_ok = true;
+    for (auto it_code : prev_code) {
+      if (WriteItem(it_code.first, "Baud Rate", static_cast<uint32_t>(target_code)) !=
+        DxlError::OK)
+      {
+        fprintf(stderr, "[ID:%03d] Cannot write the baud rate\n", it_code.first);
+        fail_id_arr.push_back(it_code.first);
+        write_ok = false;
+      }
+    }
+    port_handler_->setBaudRate(target_baudrate);
+
+    if (!write_ok || !PingAll(id_arr)) {
+      fprintf(
+        stderr, "Failed to change the baudrate to [%d], rolling back to [%d]\n",
+        target_baudrate, current_baudrate);
+      // servos that did not switch do not answer here and keep their baud rate anyway
+      for (auto it_code : prev_code) {
+        WriteItem(it_code.first, "Baud Rate", it_code.second);
+      }
+      port_handler_->setBaudRate(current_baudrate);
+      if (!PingAll(id_arr)) {
+        fprintf(stderr, "Rollback incomplete, check the baud rate of every servo!\n");
+      }
+      return DxlError::BUS_TIMING_FAIL;
+    }
+    fprintf(stderr, "Succeeded to change the bus to [%d] baudrate!\n", target_baudrate);
+  }
+
+  std::map<uint8_t, uint32_t> changed_delay;
+  for (auto it_delay : prev_delay) {
+    if (WriteItem(it_delay.first, "Return Delay Time", 0) != DxlError::OK) {
+      fprintf(
+        stderr, "[ID:%03d] Cannot write the Return Delay Time, keep %u\n",
+        it_delay.first, it_delay.second);
+      fail_id_arr.push_back(it_delay.first);
+      continue;
+    }
+    changed_delay[it_delay.first] = it_delay.second;
+    fprintf(stderr, "[ID:%03d] Return Delay Time %u -> 0\n", it_delay.first, it_delay.second);
+  }
+
+  if (!changed_delay.empty() && !PingAll(id_arr)) {
+    fprintf(stderr, "Servos lost after the Return Delay Time change, rolling back\n");
+    for (auto it_delay : changed_delay) {
+      WriteItem(it_delay.first, "Return Delay Time", it_delay.second);
+    }
+    return DxlError::BUS_TIMING_FAIL;
+  }
+
+  // the baud rate change stands, the IDs in fail_id_arr keep their Return Delay Time
+  return fail_id_arr.empty() ? DxlError::OK : DxlError::BUS_TIMING_FAIL;
+}
+
+bool Dynamixel::PingAll(const std::vector<uint8_t> & id_arr)
+{
+  for (auto it_id : id_arr) {
+    uint8_t dxl_error = 0;
+    int dxl_comm_result = packet_handler_->ping(port_handler_, it_id, &dxl_error);
+    if (dxl_comm_result != COMM_SUCCESS) {
+      fprintf(
+        stderr, "[ID:%03d] Ping failed : %s\n",
+        it_id, packet_handler_->getTxRxResult(dxl_comm_result));
+      return false;
+    }
+  }
+  return true;
+}
+
 void Dynamixel::RWDataReset()
 {
+  ClearReadGroups();
+  ClearSensorReadGroups();
   read_data_list_.clear();
+  sensor_read_data_list_.clear();
   write_data_list_.clear();
+  write_encode_plan_.clear();
+  write_blocks_.clear();
 }
 
 DxlError Dynamixel::SetDxlReadItems(
   uint8_t id,
   std::vector<std::string> item_names,
-  std::vector<std::shared_ptr<double>> data_vec_ptr)
+  std::vector<double *> data_vec_ptr,
+  uint32_t read_divisor,
+  size_t fast_item_cnt)
 {
   if (item_names.size() == 0) {
     fprintf(stderr, "[ID:%03d] No (Sync or Bulk) Read Item\n", id);
@@ -137,6 +396,53 @@ DxlError Dynamixel::SetDxlReadItems(
   }
 
   RWItemList read_item;
+  DxlError result = MakeReadItemList(id, item_names, data_vec_ptr, read_item);
+  if (result != DxlError::OK) {
+    return result;
+  }
+  if (read_divisor > 1 && fast_item_cnt < item_names.size()) {
+    read_item.fast_item_cnt = static_cast<uint16_t>(fast_item_cnt);
+    read_item.read_divisor = read_divisor;
+  } else {
+    read_item.fast_item_cnt = static_cast<uint16_t>(item_names.size());
+    read_item.read_divisor = 1;
+  }
+
+  read_data_list_.push_back(read_item);
+
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::SetDxlSensorReadItems(
+  uint8_t id,
+  std::vector<std::string> item_names,
+  std::vector<double *> data_vec_ptr,
+  uint32_t read_divisor)
+{
+  if (item_names.size() == 0) {
+    fprintf(stderr, "[ID:%03d] No Sensor Read Item\n", id);
+    return DxlError::OK;
+  }
+
+  RWItemList read_item;
+  DxlError result = MakeReadItemList(id, item_names, data_vec_ptr, read_item);
+  if (result != DxlError::OK) {
+    return result;
+  }
+  read_item.fast_item_cnt = static_cast<uint16_t>(item_names.size());
+  read_item.read_divisor = std::max<uint32_t>(read_divisor, 1);
+
+  sensor_read_data_list_.push_back(read_item);
+
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::MakeReadItemList(
+  uint8_t id,
+  const std::vector<std::string> & item_names,
+  const std::vector<double *> & data_vec_ptr,
+  RWItemList & read_item)
+{
   read_item.id = id;
 
   for (auto it_name : item_names) {
@@ -161,20 +467,19 @@ DxlError Dynamixel::SetDxlReadItems(
   }
 
   read_item.item_data_ptr_vec = data_vec_ptr;
-
-  read_data_list_.push_back(read_item);
-
   return DxlError::OK;
 }
 
 DxlError Dynamixel::SetMultiDxlRead()
 {
-  if (read_data_list_.size() < 2) {
-    read_type_ = SYNC;
-  } else {
-    read_type_ = checkReadType();
+  if (read_data_list_.empty()) {
+    // a port with sensors only
+    ClearReadGroups();
+    return SetSensorReadGroups();
   }
 
+  read_type_ = checkReadType();
+
   fprintf(stderr, "Dynamixel Read Type : %s\n", read_type_ ? "bulk read" : "sync read");
   if (read_type_ == SYNC) {
     fprintf(stderr, "ID : ");
@@ -198,17 +503,22 @@ DxlError Dynamixel::SetMultiDxlRead()
     }
   }
 
+  DxlError result;
   if (read_type_ == SYNC) {
-    return SetSyncReadItemAndHandler();
+    result = SetSyncReadItemAndHandler();
   } else {
-    return SetBulkReadItemAndHandler();
+    result = SetBulkReadItemAndHandler();
   }
+  if (result != DxlError::OK) {
+    return result;
+  }
+  return SetSensorReadGroups();
 }
 
 DxlError Dynamixel::SetDxlWriteItems(
   uint8_t id,
   std::vector<std::string> item_names,
-  std::vector<std::shared_ptr<double>> data_vec_ptr)
+  std::vector<double *> data_vec_ptr)
 {
   if (item_names.size() == 0) {
     fprintf(stderr, "[ID:%03d] No (Sync or Bulk) Write Item\n", id);
@@ -274,12 +584,17 @@ DxlError Dynamixel::SetMultiDxlWrite()
     }
   }
 
+  DxlError result;
   if (write_type_ == SYNC) {
-    SetSyncWriteItemAndHandler();
+    result = SetSyncWriteItemAndHandler();
   } else {
-    SetBulkWriteItemAndHandler();
+    result = SetBulkWriteItemAndHandler();
+  }
+  if (result != DxlError::OK) {
+    return result;
   }
 
+  BuildWriteEncodePlan();
   return DxlError::OK;
 }
 
@@ -350,10 +665,13 @@ DxlError Dynamixel::WriteItem(uint8_t id, std::string item_name, uint32_t data)
 
 DxlError Dynamixel::WriteItem(uint8_t id, uint16_t addr, uint8_t size, uint32_t data)
 {
+  FinishReadRequest();
+  // the servo state may no longer match what the sync/bulk write last sent
+  InvalidateWriteBlock(id);
+
   int dxl_comm_result = COMM_TX_FAIL;
   uint8_t dxl_error = 0;
 
-
   if (size == 1) {
     dxl_comm_result =
       packet_handler_->write1ByteTxRx(
@@ -387,6 +705,158 @@ DxlError Dynamixel::WriteItem(uint8_t id, uint16_t addr, uint8_t size, uint32_t
   return DxlError::OK;
 }
 
+DxlError Dynamixel::SyncConfigItems(std::vector<RWItemBufInfo> & items)
+{
+  for (auto & item : items) {
+    if (dxl_info_.GetDxlControlItem(
+        item.id, item.control_item.item_name,
+        item.control_item.address, item.control_item.size) == false)
+    {
+      fprintf(
+        stderr, "[ID:%03d] Cannot find control item in model file. : %s\n", item.id,
+        item.control_item.item_name.c_str());
+      return DxlError::CANNOT_FIND_CONTROL_ITEM;
+    }
+    if (item.control_item.size > 4) {
+      // item.data holds 4 bytes at most
+      fprintf(
+        stderr, "[ID:%03d] %s is %u bytes, at most 4 can be set\n", item.id,
+        item.control_item.item_name.c_str(), item.control_item.size);
+      return DxlError::ITEM_WRITE_FAIL;
+    }
+  }
+  FinishReadRequest();
+
+  // read the range covering all items of an ID, every ID in one bulk read
+  std::map<uint8_t, std::pair<uint16_t, uint16_t>> range;  // id -> [start, end)
+  for (const auto & item : items) {
+    uint16_t start = item.control_item.address;
+    uint16_t end = static_cast<uint16_t>(start + item.control_item.size);
+    auto it = range.find(item.id);
+    if (it == range.end()) {
+      range[item.id] = std::make_pair(start, end);
+    } else {
+      it->second.first = std::min(it->second.first, start);
+      it->second.second = std::max(it->second.second, end);
+    }
+  }
+  dynamixel::GroupBulkRead config_read(port_handler_, packet_handler_);
+  bool read_ok = true;
+  for (const auto & it : range) {
+    if (!config_read.addParam(it.first, it.second.first, it.second.second - it.second.first)) {
+      // also the case without bulk read (Protocol 1.0)
+      fprintf(stderr, "[ID:%03d] Config BulkRead addParam failed, writing every item\n", it.first);
+      read_ok = false;
+      break;
+    }
+  }
+  int dxl_comm_result = COMM_SUCCESS;
+  if (read_ok) {
+    dxl_comm_result = config_read.txRxPacket();
+    if (dxl_comm_result != COMM_SUCCESS) {
+      fprintf(
+        stderr, "Config BulkRead Fail - %s, writing every item\n",
+        packet_handler_->getTxRxResult(dxl_comm_result));
+      read_ok = false;
+    }
+  }
+  if (!read_ok) {
+    for (const auto & item : items) {
+      DxlError result = WriteItem(
+        item.id, item.control_item.address, item.control_item.size, item.data);
+      if (result != DxlError::OK) {
+        return result;
+      }
+    }
+    return DxlError::OK;
+  }
+
+  // items that differ, in rounds of at most one item per ID (a bulk write holds one block per ID)
+  std::vector<std::vector<const RWItemBufInfo *>> rounds;
+  std::map<uint8_t, size_t> id_round;
+  for (const auto & item : items) {
+    uint32_t mask = item.control_item.size >= 4 ?
+      0xFFFFFFFF : (1u << (8 * item.control_item.size)) - 1;
+    uint32_t present = config_read.getData(
+      item.id, item.control_item.address, item.control_item.size);
+    if ((present & mask) == (item.data & mask)) {
+      continue;
+    }
+    fprintf(
+      stderr, "[ID:%03d] %s : %u -> %u\n", item.id, item.control_item.item_name.c_str(),
+      present & mask, item.data & mask);
+    size_t round = id_round[item.id]++;
+    if (rounds.size() <= round) {
+      rounds.resize(round + 1);
+    }
+    rounds.at(round).push_back(&item);
+  }
+  if (rounds.empty()) {
+    fprintf(stderr, "Config sync : %zu items already set\n", items.size());
+    return DxlError::OK;
+  }
+
+  size_t write_cnt = 0;
+  for (const auto & round : rounds) {
+    dynamixel::GroupBulkWrite config_write(port_handler_, packet_handler_);
+    bool write_ok = true;
+    for (const auto * item : round) {
+      // the servo state may no longer match what the sync/bulk write last sent
+      InvalidateWriteBlock(item->id);
+      uint8_t param[4];
+      for (uint8_t i = 0; i < item->control_item.size; i++) {
+        param[i] = static_cast<uint8_t>((item->data >> (8 * i)) & 0xFF);
+      }
+      if (write_ok &&
+        !config_write.addParam(
+          item->id, item->control_item.address, item->control_item.size, param))
+      {
+        write_ok = false;
+      }
+    }
+    dxl_comm_result = write_ok ? config_write.txPacket() : COMM_NOT_AVAILABLE;
+    if (dxl_comm_result == COMM_NOT_AVAILABLE) {
+      // addParam refused an item or no bulk write (Protocol 1.0), one write per item
+      for (const auto * item : round) {
+        DxlError result = WriteItem(
+          item->id, item->control_item.address, item->control_item.size, item->data);
+        if (result != DxlError::OK) {
+          return result;
+        }
+      }
+    } else if (dxl_comm_result != COMM_SUCCESS) {
+      fprintf(
+        stderr, "Config BulkWrite Fail - %s\n",
+        packet_handler_->getTxRxResult(dxl_comm_result));
+      return DxlError::BULK_WRITE_FAIL;
+    }
+    write_cnt += round.size();
+  }
+
+  // a bulk write has no status packet, read back to see that every value was taken
+  dxl_comm_result = config_read.txRxPacket();
+  if (dxl_comm_result != COMM_SUCCESS) {
+    fprintf(
+      stderr, "Config BulkRead Fail - %s\n", packet_handler_->getTxRxResult(dxl_comm_result));
+    return DxlError::BULK_READ_FAIL;
+  }
+  DxlError result = DxlError::OK;
+  for (const auto & item : items) {
+    uint32_t mask = item.control_item.size >= 4 ?
+      0xFFFFFFFF : (1u << (8 * item.control_item.size)) - 1;
+    uint32_t present = config_read.getData(
+      item.id, item.control_item.address, item.control_item.size);
+    if ((present & mask) != (item.data & mask)) {
+      fprintf(
+        stderr, "[ID:%03d] %s was not applied (%u)\n", item.id,
+        item.control_item.item_name.c_str(), present & mask);
+      result = DxlError::ITEM_WRITE_FAIL;
+    }
+  }
+  fprintf(stderr, "Config sync : %zu of %zu items written\n", write_cnt, items.size());
+  return result;
+}
+
 DxlError Dynamixel::InsertWriteItemBuf(uint8_t id, std::string item_name, uint32_t data)
 {
   RWItemBufInfo item;
@@ -460,6 +930,8 @@ DxlError Dynamixel::ReadItem(uint8_t id, std::string item_name, uint32_t & data)
     return DxlError::CANNOT_FIND_CONTROL_ITEM;
   }
 
+  FinishReadRequest();
+
   int dxl_comm_result = COMM_TX_FAIL;
   uint8_t dxl_error = 0;
 
@@ -522,6 +994,11 @@ DxlError Dynamixel::InsertReadItemBuf(uint8_t id, std::string item_name)
 
 DxlError Dynamixel::ReadItemBuf()
 {
+  if (read_item_buf_.empty()) {
+    return DxlError::OK;
+  }
+  FinishReadRequest();
+
   for (auto it_read_item = read_item_buf_.begin(); it_read_item < read_item_buf_.end();
     it_read_item++)
   {
@@ -554,16 +1031,24 @@ DxlError Dynamixel::ReadItemBuf()
       }
 
       if (dxl_comm_result != COMM_SUCCESS) {
-        fprintf(
-          stderr, "[ID:%03d] COMM_ERROR : %s\n",
-          id,
-          packet_handler_->getTxRxResult(dxl_comm_result));
+        if (log_ring_) {
+          log_ring_->Log(LOG_ITEM_READ_COMM_FAIL, id, dxl_comm_result);
+        } else {
+          fprintf(
+            stderr, "[ID:%03d] COMM_ERROR : %s\n",
+            id,
+            packet_handler_->getTxRxResult(dxl_comm_result));
+        }
         return DxlError::ITEM_READ_FAIL;
       } else if (dxl_error != 0) {
-        fprintf(
-          stderr, "[ID:%03d] RX_PACKET_ERROR : %s\n",
-          id,
-          packet_handler_->getRxPacketError(dxl_error));
+        if (log_ring_) {
+          log_ring_->Log(LOG_ITEM_READ_PACKET_ERROR, id, dxl_error);
+        } else {
+          fprintf(
+            stderr, "[ID:%03d] RX_PACKET_ERROR : %s\n",
+            id,
+            packet_handler_->getRxPacketError(dxl_error));
+        }
         return DxlError::ITEM_READ_FAIL;
       } else {
         it_read_item->read_flag = true;
@@ -633,20 +1118,52 @@ std::string Dynamixel::DxlErrorToString(DxlError error_num)
       return "DLX_HARDWARE_ERROR";
     case DXL_REBOOT_FAIL:
       return "DXL_REBOOT_FAIL";
+    case BUS_TIMING_FAIL:
+      return "BUS_TIMING_FAIL";
+    case DXL_NOT_FOUND:
+      return "DXL_NOT_FOUND";
   }
 }
 
 DxlError Dynamixel::ReadMultiDxlData()
 {
-  if (read_type_ == SYNC) {
-    return GetDxlValueFromSyncRead();
-  } else {
-    return GetDxlValueFromBulkRead();
+  DxlError result = DxlError::OK;
+  if (!read_data_list_.empty()) {
+    if (read_type_ == SYNC) {
+      result = GetDxlValueFromSyncRead();
+    } else {
+      result = GetDxlValueFromBulkRead();
+    }
+  }
+  // sensors after the servos, a sensor that does not answer never fails the servo states
+  ReadSensorData();
+  return result;
+}
+
+DxlError Dynamixel::RequestMultiDxlData()
+{
+  if (read_requested_ || read_data_list_.empty()) {
+    return DxlError::OK;
+  }
+
+  NextReadGroup();
+  int dxl_comm_result = TxReadPacket();
+  if (dxl_comm_result != COMM_SUCCESS) {
+    if (log_ring_) {
+      log_ring_->Log(LOG_READ_REQUEST_FAIL, 0, dxl_comm_result);
+    } else {
+      fprintf(stderr, "Read Request Tx Fail [Error code : %d]\n", dxl_comm_result);
+    }
+    return read_type_ == SYNC ? DxlError::SYNC_READ_FAIL : DxlError::BULK_READ_FAIL;
   }
+  read_requested_ = true;
+  return DxlError::OK;
 }
 
 DxlError Dynamixel::WriteMultiDxlData()
 {
+  FinishReadRequest();
+
   if (write_type_ == SYNC) {
     return SetDxlValueToSyncWrite();
   } else {
@@ -656,6 +1173,17 @@ DxlError Dynamixel::WriteMultiDxlData()
 
 bool Dynamixel::checkReadType()
 {
+  // IDs without indirect addresses (e.g. sensor boards) are read in place, only bulk read can
+  for (const auto & it_read_data : read_data_list_) {
+    uint16_t indirect_addr;
+    uint8_t indirect_size;
+    if (!dxl_info_.GetDxlControlItem(
+        it_read_data.id, "Indirect Data Read", indirect_addr, indirect_size))
+    {
+      return BULK;
+    }
+  }
+
   for (size_t dxl_index = 1; dxl_index < read_data_list_.size(); dxl_index++) {
     // Check if Indirect Data Read address and size are different
     uint16_t indirect_addr[2];  // [i-1], [i]
@@ -675,7 +1203,11 @@ bool Dynamixel::checkReadType()
     }
 
     if (read_data_list_.at(dxl_index).item_name.size() !=
-      read_data_list_.at(dxl_index - 1).item_name.size())
+      read_data_list_.at(dxl_index - 1).item_name.size() ||
+      read_data_list_.at(dxl_index).fast_item_cnt !=
+      read_data_list_.at(dxl_index - 1).fast_item_cnt ||
+      read_data_list_.at(dxl_index).read_divisor !=
+      read_data_list_.at(dxl_index - 1).read_divisor)
     {
       return BULK;
     }
@@ -744,7 +1276,6 @@ DxlError Dynamixel::SetSyncReadItemAndHandler()
     id_arr.push_back(it_read_data.id);
   }
 
-  DynamixelDisable(id_arr);
   ResetIndirectRead(id_arr);
 
   for (auto it_read_data : read_data_list_) {
@@ -766,6 +1297,11 @@ DxlError Dynamixel::SetSyncReadItemAndHandler()
     }
   }
 
+  if (UpdateIndirectAddr(id_arr, indirect_info_read_, "Indirect Address Read") != DxlError::OK) {
+    fprintf(stderr, "Cannot write the indirect address read table.\n");
+    return DxlError::SET_SYNC_READ_FAIL;
+  }
+
   if (SetSyncReadHandler(id_arr) != DxlError::OK) {
     fprintf(stderr, "Cannot set the SyncRead handler.\n");
     return DxlError::SYNC_READ_FAIL;
@@ -798,55 +1334,43 @@ DxlError Dynamixel::SetSyncReadHandler(std::vector<uint8_t> id_arr)
     "set sync read (indirect addr) : addr %d, size %d\n",
     IN_ADDR, indirect_info_read_[id_arr.at(0)].size);
 
-  group_sync_read_ =
-    new dynamixel::GroupSyncRead(
-    port_handler_, packet_handler_,
-    IN_ADDR, indirect_info_read_[id_arr.at(0)].size);
-
-  for (auto it_id : id_arr) {
-    if (group_sync_read_->addParam(it_id) != true) {
-      fprintf(stderr, "[ID:%03d] groupSyncRead addparam failed", it_id);
-      return DxlError::SET_SYNC_READ_FAIL;
-    }
-  }
-
-  return DxlError::OK;
+  return SetReadGroups();
 }
 
 DxlError Dynamixel::GetDxlValueFromSyncRead()
 {
-  // SyncRead tx
-  int dxl_comm_result = group_sync_read_->txRxPacket();
+  // SyncRead (or FastSyncRead, all IDs answer in a single status packet) txrx
+  auto txrx_start = std::chrono::steady_clock::now();
+  int dxl_comm_result = TxRxReadPacket();
+  auto decode_start = std::chrono::steady_clock::now();
+  read_txrx_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    decode_start - txrx_start).count();
+  read_decode_ns_ = 0;
+  bool fast = active_read_ != nullptr && active_read_->fast_sync_read != nullptr;
   if (dxl_comm_result != COMM_SUCCESS) {
-    fprintf(stderr, "SyncRead TxRx Fail [Error code : %d]\n", dxl_comm_result);
+    if (log_ring_) {
+      log_ring_->Log(LOG_SYNC_READ_FAIL, 0, dxl_comm_result, fast ? 1 : 0);
+    } else {
+      fprintf(
+        stderr, "%sSyncRead TxRx Fail [Error code : %d]\n",
+        fast ? "Fast" : "", dxl_comm_result);
+    }
     return DxlError::SYNC_READ_FAIL;
   }
 
-  for (auto it_read_data : read_data_list_) {
-    uint8_t ID = it_read_data.id;
-    uint16_t IN_ADDR = indirect_info_read_[ID].indirect_data_addr;
-
-    for (size_t item_index = 0; item_index < indirect_info_read_[ID].cnt; item_index++) {
-      uint8_t SIZE = indirect_info_read_[ID].item_size.at(item_index);
-      if (item_index > 0) {IN_ADDR += indirect_info_read_[ID].item_size.at(item_index - 1);}
-
-      uint32_t dxl_getdata = group_sync_read_->getData(ID, IN_ADDR, SIZE);
-
-      if (indirect_info_read_[ID].item_name.at(item_index) == "Present Position") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          dxl_info_.ConvertValueToRadian(ID, static_cast<int32_t>(dxl_getdata));
-      } else if (indirect_info_read_[ID].item_name.at(item_index) == "Present Velocity") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          dxl_info_.ConvertValueRPMToVelocityRPS(ID, static_cast<int32_t>(dxl_getdata));
-      } else if (indirect_info_read_[ID].item_name.at(item_index) == "Present Current") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          static_cast<int16_t>(dxl_getdata);
-      } else {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          static_cast<double>(dxl_getdata);
-      }
+  if (fast) {
+    for (const auto & item : active_read_->decode_plan) {
+      uint32_t dxl_getdata = active_read_->fast_sync_read->getData(item.id, item.addr, item.size);
+      *item.data_ptr = DecodeReadItem(item, dxl_getdata);
+    }
+  } else {
+    for (const auto & item : active_read_->decode_plan) {
+      uint32_t dxl_getdata = active_read_->sync_read->getData(item.id, item.addr, item.size);
+      *item.data_ptr = DecodeReadItem(item, dxl_getdata);
     }
   }
+  read_decode_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - decode_start).count();
   return DxlError::OK;
 }
 
@@ -857,7 +1381,6 @@ DxlError Dynamixel::SetBulkReadItemAndHandler()
     id_arr.push_back(it_read_data.id);
   }
 
-  DynamixelDisable(id_arr);
   ResetIndirectRead(id_arr);
 
   for (auto it_read_data : read_data_list_) {
@@ -885,6 +1408,20 @@ DxlError Dynamixel::SetBulkReadItemAndHandler()
     }
   }
 
+  std::vector<uint8_t> indirect_id_arr;
+  for (auto it_id : id_arr) {
+    if (!indirect_info_read_[it_id].direct) {
+      indirect_id_arr.push_back(it_id);
+    }
+  }
+  if (!indirect_id_arr.empty() &&
+    UpdateIndirectAddr(
+      indirect_id_arr, indirect_info_read_, "Indirect Address Read") != DxlError::OK)
+  {
+    fprintf(stderr, "Cannot write the indirect address read table.\n");
+    return DxlError::SET_BULK_READ_FAIL;
+  }
+
   if (SetBulkReadHandler(id_arr) != DxlError::OK) {
     fprintf(stderr, "Cannot set the BulkRead handler.\n");
     return DxlError::SYNC_READ_FAIL;
@@ -900,7 +1437,26 @@ DxlError Dynamixel::SetBulkReadHandler(std::vector<uint8_t> id_arr)
   uint8_t IN_SIZE = 0;
 
   for (auto it_id : id_arr) {
-    // Get the indirect addr.
+    IndirectInfo & indirect_info = indirect_info_read_[it_id];
+    if (indirect_info.direct) {
+      // one range from the lowest to the highest item byte
+      auto range = std::minmax_element(
+        indirect_info.addr_table.begin(), indirect_info.addr_table.end());
+      if (indirect_info.addr_table.empty() || *range.second - *range.first + 1 > UINT8_MAX) {
+        fprintf(stderr, "[ID:%03d] Cannot read the items in place with one bulk read\n", it_id);
+        return DxlError::SET_BULK_READ_FAIL;
+      }
+      indirect_info.indirect_data_addr = *range.first;
+      indirect_info.size = static_cast<uint8_t>(*range.second - *range.first + 1);
+
+      fprintf(
+        stderr,
+        "[ID:%03d] set bulk read (direct addr) : addr %d, size %d\n",
+        it_id, indirect_info.indirect_data_addr, indirect_info.size);
+      continue;
+    }
+
+    // Get the indirect addr.
     if (dxl_info_.GetDxlControlItem(it_id, "Indirect Data Read", IN_ADDR, IN_SIZE) == false) {
       fprintf(
         stderr,
@@ -909,75 +1465,583 @@ DxlError Dynamixel::SetBulkReadHandler(std::vector<uint8_t> id_arr)
       return DxlError::SET_BULK_READ_FAIL;
     }
     // Set indirect addr.
-    indirect_info_read_[it_id].indirect_data_addr = IN_ADDR;
+    indirect_info.indirect_data_addr = IN_ADDR;
 
     fprintf(
       stderr,
       "set bulk read (indirect addr) : addr %d, size %d\n",
-      IN_ADDR, indirect_info_read_[id_arr.at(0)].size);
+      IN_ADDR, indirect_info.size);
   }
 
-  group_bulk_read_ = new dynamixel::GroupBulkRead(port_handler_, packet_handler_);
+  return SetReadGroups();
+}
 
-  for (auto it_id : id_arr) {
-    uint8_t ID = it_id;
-    uint16_t ADDR = indirect_info_read_[ID].indirect_data_addr;
-    uint8_t SIZE = indirect_info_read_[ID].size;
-    auto addParamResult = group_bulk_read_->addParam(ID, ADDR, SIZE);
-    if (addParamResult) {  // success
+DxlError Dynamixel::GetDxlValueFromBulkRead()
+{
+  // BulkRead (or FastBulkRead, all IDs answer in a single status packet) txrx
+  auto txrx_start = std::chrono::steady_clock::now();
+  int dxl_comm_result = TxRxReadPacket();
+  auto decode_start = std::chrono::steady_clock::now();
+  read_txrx_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    decode_start - txrx_start).count();
+  read_decode_ns_ = 0;
+  bool fast = active_read_ != nullptr && active_read_->fast_bulk_read != nullptr;
+  if (dxl_comm_result != COMM_SUCCESS) {
+    if (log_ring_) {
+      log_ring_->Log(LOG_BULK_READ_FAIL, 0, dxl_comm_result, fast ? 1 : 0);
+    } else {
       fprintf(
-        stderr, "[ID:%03d] Add BulkRead item : [Indirect Item Data][%d][%d]\n", ID, ADDR, SIZE);
+        stderr, "%sBulkRead TxRx Fail [Error code : %d]\n",
+        fast ? "Fast" : "", dxl_comm_result);
+    }
+    return DxlError::BULK_READ_FAIL;
+  }
+
+  if (fast) {
+    for (const auto & item : active_read_->decode_plan) {
+      uint32_t dxl_getdata = active_read_->fast_bulk_read->getData(item.id, item.addr, item.size);
+      *item.data_ptr = DecodeReadItem(item, dxl_getdata);
+    }
+  } else {
+    for (const auto & item : active_read_->decode_plan) {
+      uint32_t dxl_getdata = active_read_->bulk_read->getData(item.id, item.addr, item.size);
+      *item.data_ptr = DecodeReadItem(item, dxl_getdata);
+    }
+  }
+  read_decode_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - decode_start).count();
+  return DxlError::OK;
+}
+
+int Dynamixel::TxReadPacket()
+{
+  if (active_read_ == nullptr) {
+    return COMM_NOT_AVAILABLE;
+  }
+  if (active_read_->id.empty()) {
+    // every item of the port is slow and none is due in this cycle
+    return COMM_SUCCESS;
+  }
+  if (active_read_->fast_sync_read != nullptr) {
+    return active_read_->fast_sync_read->txPacket();
+  } else if (active_read_->sync_read != nullptr) {
+    return active_read_->sync_read->txPacket();
+  } else if (active_read_->fast_bulk_read != nullptr) {
+    return active_read_->fast_bulk_read->txPacket();
+  } else if (active_read_->bulk_read != nullptr) {
+    return active_read_->bulk_read->txPacket();
+  }
+  return COMM_NOT_AVAILABLE;
+}
+
+int Dynamixel::RxReadPacket()
+{
+  if (active_read_ == nullptr) {
+    return COMM_NOT_AVAILABLE;
+  }
+  if (active_read_->id.empty()) {
+    return COMM_SUCCESS;
+  }
+  if (active_read_->fast_sync_read != nullptr) {
+    return active_read_->fast_sync_read->rxPacket();
+  } else if (active_read_->sync_read != nullptr) {
+    return active_read_->sync_read->rxPacket();
+  } else if (active_read_->fast_bulk_read != nullptr) {
+    return active_read_->fast_bulk_read->rxPacket();
+  } else if (active_read_->bulk_read != nullptr) {
+    return active_read_->bulk_read->rxPacket();
+  }
+  return COMM_NOT_AVAILABLE;
+}
+
+int Dynamixel::TxRxReadPacket()
+{
+  if (read_requested_) {
+    // The request went out at the end of the last write, only collect the response.
+    // The timeout started at that tx, so restart it for the bytes still to come.
+    read_requested_ = false;
+    port_handler_->setPacketTimeout(active_read_->rx_packet_length);
+  } else {
+    NextReadGroup();
+    int dxl_comm_result = TxReadPacket();
+    if (dxl_comm_result != COMM_SUCCESS) {
+      return dxl_comm_result;
+    }
+  }
+  return RxReadPacket();
+}
+
+void Dynamixel::FinishReadRequest()
+{
+  // A pending read request keeps the port busy until its response is received.
+  // Only the servo read is collected, the sensors are read with the next ReadMultiDxlData().
+  if (read_requested_) {
+    if (read_type_ == SYNC) {
+      GetDxlValueFromSyncRead();
     } else {
+      GetDxlValueFromBulkRead();
+    }
+  }
+}
+
+void Dynamixel::NextReadGroup()
+{
+  if (read_schedule_.empty()) {
+    return;
+  }
+  active_read_ = &read_groups_[read_schedule_[read_cycle_]];
+  if (++read_cycle_ == read_schedule_.size()) {
+    read_cycle_ = 0;
+  }
+}
+
+DxlError Dynamixel::SetReadGroups()
+{
+  ClearReadGroups();
+
+  // slow items of the k-th ID with divisor d are read on the cycles c with c % d == k % d
+  size_t schedule_len = 1;
+  std::vector<uint32_t> phase(read_data_list_.size(), 0);
+  std::map<uint32_t, uint32_t> divisor_id_cnt;
+  for (size_t i = 0; i < read_data_list_.size(); i++) {
+    uint32_t divisor = read_data_list_.at(i).read_divisor;
+    if (divisor < 2) {
+      continue;
+    }
+    // a sync read has one length for every ID, so its slow items are all read together
+    phase.at(i) = read_type_ == SYNC ? 0 : divisor_id_cnt[divisor]++ % divisor;
+    schedule_len = schedule_len / Gcd(schedule_len, divisor) * divisor;
+    if (schedule_len > READ_SCHEDULE_MAX_CYCLE) {
       fprintf(
-        stderr, "[ID:%03d] Failed to BulkRead item : [Indirect Item Data]]\n", ID);
+        stderr, "Read divisors repeat after more than %zu cycles, use fewer distinct divisors\n",
+        READ_SCHEDULE_MAX_CYCLE);
+      return read_type_ == SYNC ? DxlError::SET_SYNC_READ_FAIL : DxlError::SET_BULK_READ_FAIL;
+    }
+  }
+
+  // cycles that read the same slow items share one prepared read
+  bool fast_read = use_fast_read_;
+  std::map<std::vector<bool>, uint16_t> group_index;
+  read_schedule_.assign(schedule_len, 0);
+  for (size_t cycle = 0; cycle < schedule_len; cycle++) {
+    std::vector<bool> slow(read_data_list_.size(), false);
+    for (size_t i = 0; i < read_data_list_.size(); i++) {
+      uint32_t divisor = read_data_list_.at(i).read_divisor;
+      slow.at(i) = divisor > 1 && cycle % divisor == phase.at(i);
+    }
+    auto it = group_index.find(slow);
+    if (it == group_index.end()) {
+      DxlError result = AddReadGroup(slow, fast_read);
+      if (result != DxlError::OK) {
+        ClearReadGroups();
+        return result;
+      }
+      it = group_index.emplace(slow, static_cast<uint16_t>(read_groups_.size() - 1)).first;
+    }
+    read_schedule_.at(cycle) = it->second;
+  }
+
+  read_cycle_ = 0;
+  active_read_ = &read_groups_.front();
+  if (schedule_len > 1) {
+    fprintf(
+      stderr, "Read schedule : %zu cycles, %zu read groups\n",
+      schedule_len, read_groups_.size());
+  }
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::AddReadGroup(const std::vector<bool> & slow, bool & fast_read)
+{
+  read_groups_.push_back(ReadGroup());
+  ReadGroup & group = read_groups_.back();
+  group.sync_read = nullptr;
+  group.fast_sync_read = nullptr;
+  group.bulk_read = nullptr;
+  group.fast_bulk_read = nullptr;
+  group.rx_packet_length = 0;
+
+  for (size_t i = 0; i < read_data_list_.size(); i++) {
+    const RWItemList & read_data = read_data_list_.at(i);
+    const IndirectInfo & indirect_info = indirect_info_read_[read_data.id];
+    uint16_t item_cnt = slow.at(i) ? indirect_info.cnt :
+      std::min(read_data.fast_item_cnt, indirect_info.cnt);
+    if (item_cnt == 0) {
+      continue;
+    }
+
+    // fast items come first in the indirect data area, so every read is one range
+    uint16_t bytes = 0;
+    for (size_t item_index = 0; item_index < item_cnt; item_index++) {
+      bytes += indirect_info.item_size.at(item_index);
+    }
+    uint16_t addr = indirect_info.indirect_data_addr;
+    uint16_t length = bytes;
+    if (indirect_info.direct) {
+      auto range = std::minmax_element(
+        indirect_info.addr_table.begin(), indirect_info.addr_table.begin() + bytes);
+      addr = *range.first;
+      length = *range.second - *range.first + 1;
+    }
+
+    group.id.push_back(read_data.id);
+    group.addr.push_back(addr);
+    group.length.push_back(static_cast<uint8_t>(length));
+    // status packet : header(4) ID(1) LENGTH(2) INST(1) ERR(1) DATA CRC(2)
+    group.rx_packet_length += 11 + length;
+    AddReadDecodeItems(read_data, item_cnt, group.decode_plan);
+  }
+
+  if (group.id.empty()) {
+    return DxlError::OK;
+  }
+
+  if (read_type_ == SYNC) {
+    // the IDs of a sync read share its address and length
+    if (fast_read) {
+      group.fast_sync_read = new dynamixel::GroupFastSyncRead(
+        port_handler_, packet_handler_, group.addr.at(0), group.length.at(0));
+
+      bool add_param_result = true;
+      for (auto it_id : group.id) {
+        if (group.fast_sync_read->addParam(it_id) != true) {
+          fprintf(stderr, "[ID:%03d] groupFastSyncRead addparam failed\n", it_id);
+          add_param_result = false;
+          break;
+        }
+      }
+
+      // Firmware without Fast Sync Read does not answer 0x8A, so probe once before using it.
+      int dxl_comm_result = COMM_TX_FAIL;
+      if (add_param_result) {
+        dxl_comm_result = group.fast_sync_read->txRxPacket();
+      }
+      if (add_param_result && dxl_comm_result == COMM_SUCCESS) {
+        if (read_groups_.size() == 1) {
+          fprintf(stderr, "Use Fast Sync Read\n");
+        }
+        return DxlError::OK;
+      }
+      fprintf(
+        stderr, "Fast Sync Read is not supported [%s], fall back to Sync Read\n",
+        packet_handler_->getTxRxResult(dxl_comm_result));
+      delete group.fast_sync_read;
+      group.fast_sync_read = nullptr;
+      fast_read = false;
+    }
+
+    group.sync_read = new dynamixel::GroupSyncRead(
+      port_handler_, packet_handler_, group.addr.at(0), group.length.at(0));
+    for (auto it_id : group.id) {
+      if (group.sync_read->addParam(it_id) != true) {
+        fprintf(stderr, "[ID:%03d] groupSyncRead addparam failed", it_id);
+        return DxlError::SET_SYNC_READ_FAIL;
+      }
+    }
+    return DxlError::OK;
+  }
+
+  if (fast_read) {
+    group.fast_bulk_read = new dynamixel::GroupFastBulkRead(port_handler_, packet_handler_);
+
+    bool add_param_result = true;
+    for (size_t i = 0; i < group.id.size(); i++) {
+      if (group.fast_bulk_read->addParam(
+          group.id.at(i), group.addr.at(i), group.length.at(i)) != true)
+      {
+        fprintf(stderr, "[ID:%03d] groupFastBulkRead addparam failed\n", group.id.at(i));
+        add_param_result = false;
+        break;
+      }
+    }
+
+    // Firmware without Fast Bulk Read does not answer 0x9A, so probe once before using it.
+    int dxl_comm_result = COMM_TX_FAIL;
+    if (add_param_result) {
+      dxl_comm_result = group.fast_bulk_read->txRxPacket();
+    }
+    if (add_param_result && dxl_comm_result == COMM_SUCCESS) {
+      if (read_groups_.size() == 1) {
+        fprintf(stderr, "Use Fast Bulk Read\n");
+      }
+      return DxlError::OK;
+    }
+    fprintf(
+      stderr, "Fast Bulk Read is not supported [%s], fall back to Bulk Read\n",
+      packet_handler_->getTxRxResult(dxl_comm_result));
+    delete group.fast_bulk_read;
+    group.fast_bulk_read = nullptr;
+    fast_read = false;
+  }
+
+  group.bulk_read = new dynamixel::GroupBulkRead(port_handler_, packet_handler_);
+  for (size_t i = 0; i < group.id.size(); i++) {
+    if (group.bulk_read->addParam(group.id.at(i), group.addr.at(i), group.length.at(i)) != true) {
+      fprintf(
+        stderr, "[ID:%03d] Failed to BulkRead item : [Indirect Item Data]]\n", group.id.at(i));
       return DxlError::SET_BULK_READ_FAIL;
     }
   }
   return DxlError::OK;
 }
 
-DxlError Dynamixel::GetDxlValueFromBulkRead()
+void Dynamixel::ClearReadGroups()
 {
-  int dxl_comm_result = group_bulk_read_->txRxPacket();
-  if (dxl_comm_result != COMM_SUCCESS) {
-    fprintf(stderr, "BulkRead TxRx Fail [Error code : %d]\n", dxl_comm_result);
-    return DxlError::BULK_READ_FAIL;
+  // a pending request keeps the port busy until its response is received
+  if (read_requested_) {
+    read_requested_ = false;
+    port_handler_->setPacketTimeout(active_read_->rx_packet_length);
+    RxReadPacket();
+  }
+
+  for (auto & group : read_groups_) {
+    delete group.sync_read;
+    delete group.fast_sync_read;
+    delete group.bulk_read;
+    delete group.fast_bulk_read;
+  }
+  read_groups_.clear();
+  read_schedule_.clear();
+  read_cycle_ = 0;
+  active_read_ = nullptr;
+}
+
+void Dynamixel::AddReadDecodeItems(
+  const RWItemList & read_data, uint16_t item_cnt, std::vector<ReadDecodeItem> & plan)
+{
+  uint8_t ID = read_data.id;
+  const IndirectInfo & indirect_info = indirect_info_read_[ID];
+
+  int32_t value_of_zero_radian_position = 0;
+  int32_t value_of_max_radian_position = 0;
+  int32_t value_of_min_radian_position = 0;
+  double min_radian = 0.0;
+  double max_radian = 0.0;
+  dxl_info_.GetDxlTypeInfo(
+    ID,
+    value_of_zero_radian_position,
+    value_of_max_radian_position,
+    value_of_min_radian_position,
+    min_radian,
+    max_radian);
+
+  uint16_t IN_ADDR = indirect_info.indirect_data_addr;
+  // byte of the item in addr_table, a direct item is read from its own address
+  uint16_t offset = 0;
+  for (size_t item_index = 0; item_index < item_cnt; item_index++) {
+    ReadDecodeItem item;
+    item.id = ID;
+    item.addr = indirect_info.direct ? indirect_info.addr_table.at(offset) : IN_ADDR;
+    item.size = indirect_info.item_size.at(item_index);
+    item.is_signed = false;
+    item.converter = READ_CONV_RAW;
+    item.value_of_zero_radian_position = 0;
+    item.positive_radian_per_value = 0.0;
+    item.negative_radian_per_value = 0.0;
+    item.data_ptr = read_data.item_data_ptr_vec.at(item_index);
+
+    const std::string & item_name = indirect_info.item_name.at(item_index);
+    if (item_name == "Present Position") {
+      item.is_signed = true;
+      item.converter = READ_CONV_POSITION;
+      item.value_of_zero_radian_position = value_of_zero_radian_position;
+      item.positive_radian_per_value = max_radian /
+        static_cast<double>(value_of_max_radian_position - value_of_zero_radian_position);
+      item.negative_radian_per_value = min_radian /
+        static_cast<double>(value_of_min_radian_position - value_of_zero_radian_position);
+    } else if (item_name == "Present Velocity") {
+      item.is_signed = true;
+      item.converter = READ_CONV_VELOCITY;
+    } else if (item_name == "Present Current") {
+      item.is_signed = true;
+      item.converter = READ_CONV_CURRENT;
+    }
+
+    plan.push_back(item);
+    IN_ADDR += item.size;
+    offset += item.size;
   }
+}
 
-  for (auto it_read_data : read_data_list_) {
-    uint8_t ID = it_read_data.id;
-    uint16_t IN_ADDR = indirect_info_read_[ID].indirect_data_addr;
-
-    for (size_t item_index = 0; item_index < indirect_info_read_[ID].cnt; item_index++) {
-      uint8_t SIZE = indirect_info_read_[ID].item_size.at(item_index);
-      if (item_index > 0) {IN_ADDR += indirect_info_read_[ID].item_size.at(item_index - 1);}
-
-      uint32_t dxl_getdata = group_bulk_read_->getData(ID, IN_ADDR, SIZE);
-
-      if (indirect_info_read_[ID].item_name.at(item_index) == "Present Position") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          dxl_info_.ConvertValueToRadian(ID, static_cast<int32_t>(dxl_getdata));
-      } else if (indirect_info_read_[ID].item_name.at(item_index) == "Present Velocity") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          dxl_info_.ConvertValueRPMToVelocityRPS(ID, static_cast<int32_t>(dxl_getdata));
-      } else if (indirect_info_read_[ID].item_name.at(item_index) == "Present Current") {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          static_cast<int16_t>(dxl_getdata);
-      } else {
-        *it_read_data.item_data_ptr_vec.at(item_index) =
-          static_cast<double>(dxl_getdata);
+DxlError Dynamixel::SetSensorReadGroups()
+{
+  ClearSensorReadGroups();
+  if (sensor_read_data_list_.empty()) {
+    return DxlError::OK;
+  }
+
+  std::vector<uint8_t> id_arr;
+  for (const auto & it_read_data : sensor_read_data_list_) {
+    id_arr.push_back(it_read_data.id);
+  }
+
+  ResetIndirectRead(id_arr);
+
+  for (const auto & it_read_data : sensor_read_data_list_) {
+    for (size_t item_index = 0; item_index < it_read_data.item_name.size(); item_index++) {
+      auto result = AddIndirectRead(
+        it_read_data.id,
+        it_read_data.item_name.at(item_index),
+        it_read_data.item_addr.at(item_index),
+        it_read_data.item_size.at(item_index));
+
+      if (result != DxlError::OK) {
+        fprintf(
+          stderr, "[ID:%03d] Failed to Indirect Address Read Item : [%s], %d\n",
+          it_read_data.id,
+          it_read_data.item_name.at(item_index).c_str(),
+          result);
       }
     }
   }
+
+  std::vector<uint8_t> indirect_id_arr;
+  for (auto it_id : id_arr) {
+    if (!indirect_info_read_[it_id].direct) {
+      indirect_id_arr.push_back(it_id);
+    }
+  }
+  if (!indirect_id_arr.empty() &&
+    UpdateIndirectAddr(
+      indirect_id_arr, indirect_info_read_, "Indirect Address Read") != DxlError::OK)
+  {
+    fprintf(stderr, "Cannot write the indirect address read table of the sensors.\n");
+    return DxlError::SET_BULK_READ_FAIL;
+  }
+
+  for (const auto & read_data : sensor_read_data_list_) {
+    IndirectInfo & indirect_info = indirect_info_read_[read_data.id];
+    uint16_t addr = 0;
+    uint16_t length = indirect_info.size;
+    if (indirect_info.direct) {
+      // one range from the lowest to the highest item byte
+      auto range = std::minmax_element(
+        indirect_info.addr_table.begin(), indirect_info.addr_table.end());
+      if (indirect_info.addr_table.empty() || *range.second - *range.first + 1 > UINT8_MAX) {
+        fprintf(
+          stderr, "[ID:%03d] Cannot read the items in place with one bulk read\n", read_data.id);
+        ClearSensorReadGroups();
+        return DxlError::SET_BULK_READ_FAIL;
+      }
+      addr = *range.first;
+      length = *range.second - *range.first + 1;
+    } else {
+      uint8_t IN_SIZE = 0;
+      if (dxl_info_.GetDxlControlItem(
+          read_data.id, "Indirect Data Read", addr, IN_SIZE) == false)
+      {
+        ClearSensorReadGroups();
+        return DxlError::SET_BULK_READ_FAIL;
+      }
+    }
+    indirect_info.indirect_data_addr = addr;
+
+    // sensors with the same divisor share one bulk read
+    size_t g = std::find(
+      sensor_read_divisor_.begin(), sensor_read_divisor_.end(),
+      read_data.read_divisor) - sensor_read_divisor_.begin();
+    if (g == sensor_read_groups_.size()) {
+      ReadGroup group;
+      group.sync_read = nullptr;
+      group.fast_sync_read = nullptr;
+      group.bulk_read = new dynamixel::GroupBulkRead(port_handler_, packet_handler_);
+      group.fast_bulk_read = nullptr;
+      group.rx_packet_length = 0;
+      sensor_read_groups_.push_back(group);
+      sensor_read_divisor_.push_back(read_data.read_divisor);
+    }
+    ReadGroup & group = sensor_read_groups_.at(g);
+    if (group.bulk_read->addParam(read_data.id, addr, length) != true) {
+      fprintf(stderr, "[ID:%03d] Failed to BulkRead sensor items\n", read_data.id);
+      ClearSensorReadGroups();
+      return DxlError::SET_BULK_READ_FAIL;
+    }
+    group.id.push_back(read_data.id);
+    group.addr.push_back(addr);
+    group.length.push_back(static_cast<uint8_t>(length));
+    group.rx_packet_length += 11 + length;
+    AddReadDecodeItems(read_data, indirect_info.cnt, group.decode_plan);
+
+    fprintf(
+      stderr, "[ID:%03d] set sensor bulk read : addr %d, size %d, every %u cycles\n",
+      read_data.id, addr, length, read_data.read_divisor);
+  }
+
+  sensor_read_cycle_ = 0;
   return DxlError::OK;
 }
 
+void Dynamixel::ClearSensorReadGroups()
+{
+  for (auto & group : sensor_read_groups_) {
+    delete group.bulk_read;
+  }
+  sensor_read_groups_.clear();
+  sensor_read_divisor_.clear();
+  sensor_read_cycle_ = 0;
+}
+
+void Dynamixel::ReadSensorData()
+{
+  for (size_t g = 0; g < sensor_read_groups_.size(); g++) {
+    if (sensor_read_cycle_ % sensor_read_divisor_[g] != 0) {
+      continue;
+    }
+    ReadGroup & group = sensor_read_groups_[g];
+    int dxl_comm_result = group.bulk_read->txRxPacket();
+    if (dxl_comm_result != COMM_SUCCESS) {
+      // the sensor values keep their last reading
+      if (log_ring_) {
+        log_ring_->Log(LOG_SENSOR_READ_FAIL, 0, dxl_comm_result, sensor_read_divisor_[g]);
+      } else {
+        fprintf(stderr, "Sensor BulkRead TxRx Fail [Error code : %d]\n", dxl_comm_result);
+      }
+      continue;
+    }
+    for (const auto & item : group.decode_plan) {
+      uint32_t dxl_getdata = group.bulk_read->getData(item.id, item.addr, item.size);
+      *item.data_ptr = DecodeReadItem(item, dxl_getdata);
+    }
+  }
+  sensor_read_cycle_++;
+}
+
+double Dynamixel::DecodeReadItem(const ReadDecodeItem & item, uint32_t raw) const
+{
+  int32_t value = static_cast<int32_t>(raw);
+  if (item.is_signed && item.size < 4) {
+    uint32_t sign_bit = 1u << (item.size * 8 - 1);
+    value = static_cast<int32_t>((raw ^ sign_bit) - sign_bit);
+  }
+
+  switch (item.converter) {
+    case READ_CONV_POSITION:
+      if (value > item.value_of_zero_radian_position) {
+        return static_cast<double>(value - item.value_of_zero_radian_position) *
+               item.positive_radian_per_value;
+      } else if (value < item.value_of_zero_radian_position) {
+        return static_cast<double>(value - item.value_of_zero_radian_position) *
+               item.negative_radian_per_value;
+      }
+      return 0.0;
+    case READ_CONV_VELOCITY:
+      return static_cast<double>(value * 0.01 / 60.0 * 2.0 * M_PI);
+    case READ_CONV_CURRENT:
+      return static_cast<double>(value);
+    case READ_CONV_RAW:
+    default:
+      return static_cast<double>(raw);
+  }
+}
+
 void Dynamixel::ResetIndirectRead(std::vector<uint8_t> id_arr)
 {
   IndirectInfo temp;
   temp.cnt = temp.size = 0;
   temp.item_name.clear();
   temp.item_size.clear();
+  temp.addr_table.clear();
+  temp.direct = false;
   for (auto it_id : id_arr) {
     indirect_info_read_[it_id] = temp;
   }
@@ -989,7 +2053,7 @@ DxlError Dynamixel::AddIndirectRead(
   uint16_t item_addr,
   uint8_t item_size)
 {
-  // write address to indirect addr control item
+  // map the item in memory, the table is sent by WriteIndirectAddr()
   uint16_t INDIRECT_ADDR;
   uint8_t INDIRECT_SIZE;
   if (dxl_info_.GetDxlControlItem(
@@ -999,9 +2063,7 @@ DxlError Dynamixel::AddIndirectRead(
     uint8_t using_size = indirect_info_read_[id].size;
 
     for (uint16_t i = 0; i < item_size; i++) {
-      if (WriteItem(id, INDIRECT_ADDR + (using_size * 2), 2, item_addr + i) != DxlError::OK) {
-        return DxlError::SET_BULK_READ_FAIL;
-      }
+      indirect_info_read_[id].addr_table.push_back(item_addr + i);
       using_size++;
     }
     indirect_info_read_[id].size = using_size;
@@ -1009,6 +2071,19 @@ DxlError Dynamixel::AddIndirectRead(
     indirect_info_read_[id].item_name.push_back(item_name);
     indirect_info_read_[id].item_size.push_back(item_size);
 
+    return DxlError::OK;
+  } else if (dxl_info_.GetDxlControlItem(
+      id, "Indirect Data Read", INDIRECT_ADDR, INDIRECT_SIZE) == false)
+  {
+    // no indirect address area (sensor boards), the bulk read covers the items in place
+    for (uint16_t i = 0; i < item_size; i++) {
+      indirect_info_read_[id].addr_table.push_back(item_addr + i);
+    }
+    indirect_info_read_[id].direct = true;
+    indirect_info_read_[id].cnt += 1;
+    indirect_info_read_[id].item_name.push_back(item_name);
+    indirect_info_read_[id].item_size.push_back(item_size);
+
     return DxlError::OK;
   } else {
     return DxlError::CANNOT_FIND_CONTROL_ITEM;
@@ -1022,7 +2097,6 @@ DxlError Dynamixel::SetSyncWriteItemAndHandler()
     id_arr.push_back(it_write_data.id);
   }
 
-  DynamixelDisable(id_arr);
   ResetIndirectWrite(id_arr);
 
   for (auto it_write_data : write_data_list_) {
@@ -1041,6 +2115,11 @@ DxlError Dynamixel::SetSyncWriteItemAndHandler()
     }
   }
 
+  if (UpdateIndirectAddr(id_arr, indirect_info_write_, "Indirect Address Write") != DxlError::OK) {
+    fprintf(stderr, "Cannot write the indirect address write table.\n");
+    return DxlError::SET_SYNC_WRITE_FAIL;
+  }
+
   if (SetSyncWriteHandler(id_arr) < 0) {
     fprintf(stderr, "Cannot set the SyncWrite handler.\n");
     return DxlError::SYNC_WRITE_FAIL;
@@ -1075,54 +2154,19 @@ DxlError Dynamixel::SetSyncWriteHandler(std::vector<uint8_t> id_arr)
     "set sync write (indirect addr) : addr %d, size %d\n",
     INDIRECT_ADDR, indirect_info_write_[id_arr.at(0)].size);
 
-  group_sync_write_ =
-    new dynamixel::GroupSyncWrite(
-    port_handler_, packet_handler_,
-    INDIRECT_ADDR, indirect_info_write_[id_arr.at(0)].size);
-
   return DxlError::OK;
 }
 DxlError Dynamixel::SetDxlValueToSyncWrite()
 {
-  for (auto it_write_data : write_data_list_) {
-    uint8_t ID = it_write_data.id;
-    uint8_t * param_write_value = new uint8_t[indirect_info_write_[ID].size];
-    uint8_t added_byte = 0;
-
-
-    for (uint16_t item_index = 0; item_index < indirect_info_write_[ID].cnt; item_index++) {
-      double data = *it_write_data.item_data_ptr_vec.at(item_index);
-      if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Position") {
-        int32_t goal_position = dxl_info_.ConvertRadianToValue(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(DXL_LOWORD(goal_position));
-        param_write_value[added_byte + 1] = DXL_HIBYTE(DXL_LOWORD(goal_position));
-        param_write_value[added_byte + 2] = DXL_LOBYTE(DXL_HIWORD(goal_position));
-        param_write_value[added_byte + 3] = DXL_HIBYTE(DXL_HIWORD(goal_position));
-      } else if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Current") {
-        int16_t goal_current = dxl_info_.ConvertEffortToCurrent(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(goal_current);
-        param_write_value[added_byte + 1] = DXL_HIBYTE(goal_current);
-      } else if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Velocity") {
-        int16_t goal_velocity = dxl_info_.ConvertVelocityRPSToValueRPM(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(DXL_LOWORD(goal_velocity));
-        param_write_value[added_byte + 1] = DXL_HIBYTE(DXL_LOWORD(goal_velocity));
-        param_write_value[added_byte + 2] = DXL_LOBYTE(DXL_HIWORD(goal_velocity));
-        param_write_value[added_byte + 3] = DXL_HIBYTE(DXL_HIWORD(goal_velocity));
-      }
-      added_byte += indirect_info_write_[ID].item_size.at(item_index);
-    }
-
-    if (group_sync_write_->addParam(ID, param_write_value) != true) {
-      printf("[ID:%03d] groupSyncWrite addparam failed\n", ID);
-      return DxlError::SYNC_WRITE_FAIL;
-    }
-  }
-
-  int dxl_comm_result = group_sync_write_->txPacket();
-  group_sync_write_->clearParam();
+  EncodeWriteItems();
 
+  int dxl_comm_result = TxWritePacket(INST_SYNC_WRITE);
   if (dxl_comm_result != COMM_SUCCESS) {
-    printf("%s\n", packet_handler_->getTxRxResult(dxl_comm_result));
+    if (log_ring_) {
+      log_ring_->Log(LOG_SYNC_WRITE_FAIL, 0, dxl_comm_result);
+    } else {
+      printf("%s\n", packet_handler_->getTxRxResult(dxl_comm_result));
+    }
     return DxlError::SYNC_WRITE_FAIL;
   } else {
     return DxlError::OK;
@@ -1136,7 +2180,6 @@ DxlError Dynamixel::SetBulkWriteItemAndHandler()
     id_arr.push_back(it_write_data.id);
   }
 
-  DynamixelDisable(id_arr);
   ResetIndirectWrite(id_arr);
 
   for (auto it_write_data : write_data_list_) {
@@ -1160,6 +2203,11 @@ DxlError Dynamixel::SetBulkWriteItemAndHandler()
     }
   }
 
+  if (UpdateIndirectAddr(id_arr, indirect_info_write_, "Indirect Address Write") != DxlError::OK) {
+    fprintf(stderr, "Cannot write the indirect address write table.\n");
+    return DxlError::SET_BULK_WRITE_FAIL;
+  }
+
   if (SetBulkWriteHandler(id_arr) < 0) {
     fprintf(stderr, "Cannot set the BulkWrite handler.\n");
     return DxlError::BULK_WRITE_FAIL;
@@ -1192,60 +2240,235 @@ DxlError Dynamixel::SetBulkWriteHandler(std::vector<uint8_t> id_arr)
       IN_ADDR, indirect_info_write_[id_arr.at(0)].size);
   }
 
-  group_bulk_write_ = new dynamixel::GroupBulkWrite(port_handler_, packet_handler_);
-
   return DxlError::OK;
 }
 
 DxlError Dynamixel::SetDxlValueToBulkWrite()
 {
-  for (auto it_write_data : write_data_list_) {
+  EncodeWriteItems();
+
+  int dxl_comm_result = TxWritePacket(INST_BULK_WRITE);
+  if (dxl_comm_result != COMM_SUCCESS) {
+    if (log_ring_) {
+      log_ring_->Log(LOG_BULK_WRITE_FAIL, 0, dxl_comm_result);
+    } else {
+      printf("%s\n", packet_handler_->getTxRxResult(dxl_comm_result));
+    }
+    return DxlError::BULK_WRITE_FAIL;
+  } else {
+    return DxlError::OK;
+  }
+}
+
+void Dynamixel::SetWriteElision(
+  bool use_write_elision, uint32_t deadband,
+  uint32_t refresh_cycles)
+{
+  use_write_elision_ = use_write_elision;
+  write_deadband_ = deadband;
+  write_refresh_cycles_ = refresh_cycles;
+}
+
+void Dynamixel::BuildWriteEncodePlan()
+{
+  write_encode_plan_.clear();
+  write_param_buf_.clear();
+  write_blocks_.clear();
+
+  // sync write parameters start with [START_ADDR_L][START_ADDR_H][DATA_LEN_L][DATA_LEN_H]
+  if (write_type_ == SYNC && write_data_list_.size() > 0) {
+    const IndirectInfo & indirect_info = indirect_info_write_[write_data_list_.at(0).id];
+    write_param_buf_.push_back(DXL_LOBYTE(indirect_info.indirect_data_addr));
+    write_param_buf_.push_back(DXL_HIBYTE(indirect_info.indirect_data_addr));
+    write_param_buf_.push_back(DXL_LOBYTE(indirect_info.size));
+    write_param_buf_.push_back(DXL_HIBYTE(indirect_info.size));
+  }
+  write_header_size_ = static_cast<uint16_t>(write_param_buf_.size());
+
+  for (const auto & it_write_data : write_data_list_) {
     uint8_t ID = it_write_data.id;
-    uint8_t * param_write_value = new uint8_t[indirect_info_write_[ID].size];
-    uint8_t added_byte = 0;
-
-
-    for (uint16_t item_index = 0; item_index < indirect_info_write_[ID].cnt; item_index++) {
-      double data = *it_write_data.item_data_ptr_vec.at(item_index);
-      if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Position") {
-        int32_t goal_position = dxl_info_.ConvertRadianToValue(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(DXL_LOWORD(goal_position));
-        param_write_value[added_byte + 1] = DXL_HIBYTE(DXL_LOWORD(goal_position));
-        param_write_value[added_byte + 2] = DXL_LOBYTE(DXL_HIWORD(goal_position));
-        param_write_value[added_byte + 3] = DXL_HIBYTE(DXL_HIWORD(goal_position));
-      } else if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Current") {
-        int16_t goal_current = dxl_info_.ConvertEffortToCurrent(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(goal_current);
-        param_write_value[added_byte + 1] = DXL_HIBYTE(goal_current);
-      } else if (indirect_info_write_[ID].item_name.at(item_index) == "Goal Velocity") {
-        int32_t goal_velocity = dxl_info_.ConvertVelocityRPSToValueRPM(ID, data);
-        param_write_value[added_byte + 0] = DXL_LOBYTE(DXL_LOWORD(goal_velocity));
-        param_write_value[added_byte + 1] = DXL_HIBYTE(DXL_LOWORD(goal_velocity));
-        param_write_value[added_byte + 2] = DXL_LOBYTE(DXL_HIWORD(goal_velocity));
-        param_write_value[added_byte + 3] = DXL_HIBYTE(DXL_HIWORD(goal_velocity));
+    const IndirectInfo & indirect_info = indirect_info_write_[ID];
+
+    WriteBlock block;
+    block.id = ID;
+    block.offset = static_cast<uint16_t>(write_param_buf_.size());
+    block.first_item = static_cast<uint16_t>(write_encode_plan_.size());
+    block.item_cnt = static_cast<uint16_t>(indirect_info.cnt);
+    block.dirty = true;
+    block.sent = false;
+    block.skipped_cycles = 0;
+
+    // parameters of one ID : [ID] ([ADDR_L][ADDR_H][LEN_L][LEN_H] for bulk) DATA...
+    write_param_buf_.push_back(ID);
+    if (write_type_ == BULK) {
+      write_param_buf_.push_back(DXL_LOBYTE(indirect_info.indirect_data_addr));
+      write_param_buf_.push_back(DXL_HIBYTE(indirect_info.indirect_data_addr));
+      write_param_buf_.push_back(DXL_LOBYTE(indirect_info.size));
+      write_param_buf_.push_back(DXL_HIBYTE(indirect_info.size));
+    }
+
+    int32_t value_of_zero_radian_position = 0;
+    int32_t value_of_max_radian_position = 0;
+    int32_t value_of_min_radian_position = 0;
+    double min_radian = 0.0;
+    double max_radian = 0.0;
+    dxl_info_.GetDxlTypeInfo(
+      ID,
+      value_of_zero_radian_position,
+      value_of_max_radian_position,
+      value_of_min_radian_position,
+      min_radian,
+      max_radian);
+
+    for (size_t item_index = 0; item_index < indirect_info.cnt; item_index++) {
+      WriteEncodeItem item;
+      item.id = ID;
+      item.offset = static_cast<uint16_t>(write_param_buf_.size());
+      item.size = indirect_info.item_size.at(item_index);
+      item.converter = WRITE_CONV_RAW;
+      item.value_of_zero_radian_position = 0;
+      item.positive_value_per_radian = 0.0;
+      item.negative_value_per_radian = 0.0;
+      item.torque_constant = 0.0;
+      item.data_ptr = it_write_data.item_data_ptr_vec.at(item_index);
+      item.block = static_cast<uint16_t>(write_blocks_.size());
+
+      const std::string & item_name = indirect_info.item_name.at(item_index);
+      if (item_name == "Goal Position") {
+        item.converter = WRITE_CONV_POSITION;
+        item.value_of_zero_radian_position = value_of_zero_radian_position;
+        item.positive_value_per_radian =
+          (value_of_max_radian_position - value_of_zero_radian_position) / max_radian;
+        item.negative_value_per_radian =
+          (value_of_min_radian_position - value_of_zero_radian_position) / min_radian;
+      } else if (item_name == "Goal Current") {
+        item.converter = WRITE_CONV_CURRENT;
+        dxl_info_.GetDxlTorqueConstant(ID, item.torque_constant);
+      } else if (item_name == "Goal Velocity") {
+        item.converter = WRITE_CONV_VELOCITY;
       }
-      added_byte += indirect_info_write_[ID].item_size.at(item_index);
+
+      write_encode_plan_.push_back(item);
+      write_param_buf_.resize(write_param_buf_.size() + item.size, 0);
     }
 
-    if (group_bulk_write_->addParam(
-        ID,
-        indirect_info_write_[ID].indirect_data_addr,
-        indirect_info_write_[ID].size,
-        param_write_value) != true)
-    {
-      printf("[ID:%03d] groupBulkWrite addparam failed\n", ID);
-      return DxlError::BULK_WRITE_FAIL;
+    block.length = static_cast<uint16_t>(write_param_buf_.size() - block.offset);
+    write_blocks_.push_back(block);
+  }
+  write_value_.assign(write_encode_plan_.size(), 0);
+  write_sent_value_.assign(write_encode_plan_.size(), 0);
+
+  // header(8) + params + crc(2) + room for byte stuffing
+  write_tx_packet_.assign(10 + write_param_buf_.size() + write_param_buf_.size() / 3, 0);
+}
+
+void Dynamixel::EncodeWriteItems()
+{
+  uint8_t * param = write_param_buf_.data();
+
+  for (auto & block : write_blocks_) {
+    block.dirty = !use_write_elision_ || !block.sent ||
+      (write_refresh_cycles_ > 0 && block.skipped_cycles + 1 >= write_refresh_cycles_);
+  }
+
+  for (size_t item_index = 0; item_index < write_encode_plan_.size(); item_index++) {
+    const WriteEncodeItem & item = write_encode_plan_[item_index];
+    double data = *item.data_ptr;
+    int32_t value = 0;
+
+    switch (item.converter) {
+      case WRITE_CONV_POSITION:
+        if (data > 0) {
+          value = static_cast<int32_t>(data * item.positive_value_per_radian) +
+            item.value_of_zero_radian_position;
+        } else if (data < 0) {
+          value = static_cast<int32_t>(data * item.negative_value_per_radian) +
+            item.value_of_zero_radian_position;
+        } else {
+          value = item.value_of_zero_radian_position;
+        }
+        break;
+      case WRITE_CONV_VELOCITY:
+        value = static_cast<int32_t>(data * 100.0 * 60.0 / 2.0 / M_PI);
+        break;
+      case WRITE_CONV_CURRENT:
+        value = static_cast<int16_t>(data / item.torque_constant);
+        break;
+      case WRITE_CONV_RAW:
+      default:
+        // through int64_t, so negative items and unsigned 4 byte items both keep their bits
+        value = static_cast<int32_t>(static_cast<uint32_t>(std::llround(data)));
+        break;
+    }
+
+    uint32_t raw = static_cast<uint32_t>(value);
+    for (uint8_t i = 0; i < item.size; i++) {
+      param[item.offset + i] = static_cast<uint8_t>((raw >> (8 * i)) & 0xFF);
+    }
+
+    write_value_[item_index] = value;
+    if (use_write_elision_) {
+      // the dead-band only applies to converted goals, raw items go out on any change
+      int64_t diff = static_cast<int64_t>(value) - write_sent_value_[item_index];
+      uint32_t deadband = item.converter == WRITE_CONV_RAW ? 0 : write_deadband_;
+      if (static_cast<uint64_t>(diff < 0 ? -diff : diff) > deadband) {
+        write_blocks_[item.block].dirty = true;
+      }
     }
   }
+}
 
-  int dxl_comm_result = group_bulk_write_->txPacket();
-  group_bulk_write_->clearParam();
+int Dynamixel::TxWritePacket(uint8_t instruction)
+{
+  // Protocol 2.0 instruction packet, built in place so the write path never allocates.
+  // txPacket() adds the header, CRC and byte stuffing.
+  uint8_t * txpacket = write_tx_packet_.data();
+
+  // only the dirty ID blocks go out, the sync write header always does
+  uint16_t param_length = write_header_size_;
+  memcpy(&txpacket[8], write_param_buf_.data(), write_header_size_);
+  for (const auto & block : write_blocks_) {
+    if (block.dirty) {
+      memcpy(&txpacket[8 + param_length], &write_param_buf_[block.offset], block.length);
+      param_length += block.length;
+    }
+  }
 
-  if (dxl_comm_result != COMM_SUCCESS) {
-    printf("%s\n", packet_handler_->getTxRxResult(dxl_comm_result));
-    return DxlError::BULK_WRITE_FAIL;
-  } else {
-    return DxlError::OK;
+  int dxl_comm_result = COMM_SUCCESS;
+  if (param_length > write_header_size_) {
+    uint16_t packet_length = static_cast<uint16_t>(param_length + 3);  // INST, CRC16
+    txpacket[4] = BROADCAST_ID;
+    txpacket[5] = DXL_LOBYTE(packet_length);
+    txpacket[6] = DXL_HIBYTE(packet_length);
+    txpacket[7] = instruction;
+
+    dxl_comm_result = packet_handler_->txPacket(port_handler_, txpacket);
+    port_handler_->is_using_ = false;
+  }
+
+  for (auto & block : write_blocks_) {
+    if (dxl_comm_result != COMM_SUCCESS) {
+      // nothing is known to have arrived, resend everything next cycle
+      block.sent = false;
+    } else if (block.dirty) {
+      block.sent = true;
+      block.skipped_cycles = 0;
+      for (uint16_t i = block.first_item; i < block.first_item + block.item_cnt; i++) {
+        write_sent_value_[i] = write_value_[i];
+      }
+    } else {
+      block.skipped_cycles++;
+    }
+  }
+  return dxl_comm_result;
+}
+
+void Dynamixel::InvalidateWriteBlock(uint8_t id)
+{
+  for (auto & block : write_blocks_) {
+    if (block.id == id) {
+      block.sent = false;
+    }
   }
 }
 
@@ -1255,6 +2478,8 @@ void Dynamixel::ResetIndirectWrite(std::vector<uint8_t> id_arr)
   temp.cnt = temp.size = 0;
   temp.item_name.clear();
   temp.item_size.clear();
+  temp.addr_table.clear();
+  temp.direct = false;
   for (auto it_id : id_arr) {
     indirect_info_write_[it_id] = temp;
   }
@@ -1266,17 +2491,19 @@ DxlError Dynamixel::AddIndirectWrite(
   uint16_t item_addr,
   uint8_t item_size)
 {
-  // write address to indirect addr control item
+  // map the item in memory, the table is sent by WriteIndirectAddr()
   uint16_t INDIRECT_ADDR;
   uint8_t INDIRECT_SIZE;
-  dxl_info_.GetDxlControlItem(id, "Indirect Address Write", INDIRECT_ADDR, INDIRECT_SIZE);
+  if (dxl_info_.GetDxlControlItem(
+      id, "Indirect Address Write", INDIRECT_ADDR, INDIRECT_SIZE) == false)
+  {
+    return DxlError::CANNOT_FIND_CONTROL_ITEM;
+  }
 
   uint8_t using_size = indirect_info_write_[id].size;
 
   for (uint16_t i = 0; i < item_size; i++) {
-    if (WriteItem(id, INDIRECT_ADDR + (using_size * 2), 2, item_addr + i) != DxlError::OK) {
-      return DxlError::SET_BULK_WRITE_FAIL;
-    }
+    indirect_info_write_[id].addr_table.push_back(item_addr + i);
     using_size++;
   }
   indirect_info_write_[id].size = using_size;
@@ -1286,4 +2513,196 @@ DxlError Dynamixel::AddIndirectWrite(
 
   return DxlError::OK;
 }
+
+DxlError Dynamixel::WriteIndirectAddr(
+  const std::vector<uint8_t> & id_arr,
+  const std::map<uint8_t, IndirectInfo> & indirect_info,
+  const std::string & addr_item_name)
+{
+  FinishReadRequest();
+
+  // one block per ID, IDs whose tables share address and length go out in one sync write
+  std::map<uint8_t, std::vector<uint8_t>> table;
+  std::map<std::pair<uint16_t, uint16_t>, std::vector<uint8_t>> table_group;
+  for (auto it_id : id_arr) {
+    auto it = indirect_info.find(it_id);
+    if (it == indirect_info.end() || it->second.addr_table.empty() || table.count(it_id)) {
+      continue;
+    }
+    uint16_t INDIRECT_ADDR;
+    uint8_t INDIRECT_SIZE;
+    if (dxl_info_.GetDxlControlItem(
+        it_id, addr_item_name, INDIRECT_ADDR, INDIRECT_SIZE) == false)
+    {
+      return DxlError::CANNOT_FIND_CONTROL_ITEM;
+    }
+    std::vector<uint8_t> & block = table[it_id];
+    for (auto addr : it->second.addr_table) {
+      block.push_back(DXL_LOBYTE(addr));
+      block.push_back(DXL_HIBYTE(addr));
+    }
+    uint16_t length = static_cast<uint16_t>(block.size());
+    table_group[std::make_pair(INDIRECT_ADDR, length)].push_back(it_id);
+  }
+
+  for (auto & group : table_group) {
+    uint16_t addr = group.first.first;
+    uint16_t length = group.first.second;
+    const std::vector<uint8_t> & ids = group.second;
+
+    if (ids.size() == 1) {
+      uint8_t dxl_error = 0;
+      int dxl_comm_result = packet_handler_->writeTxRx(
+        port_handler_, ids.front(), addr, length, table[ids.front()].data(), &dxl_error);
+      if (dxl_comm_result != COMM_SUCCESS) {
+        fprintf(
+          stderr, "[ID:%03d] Indirect address write fail - %s\n", ids.front(),
+          packet_handler_->getTxRxResult(dxl_comm_result));
+        return DxlError::ITEM_WRITE_FAIL;
+      } else if (dxl_error != 0) {
+        fprintf(
+          stderr, "[ID:%03d] Indirect address write fail - %s\n", ids.front(),
+          packet_handler_->getRxPacketError(dxl_error));
+        return DxlError::ITEM_WRITE_FAIL;
+      }
+      continue;
+    }
+
+    size_t ids_per_packet =
+      std::max<size_t>(1, INDIRECT_ADDR_SYNC_WRITE_MAX_PARAM / (length + 1));
+    for (size_t first = 0; first < ids.size(); first += ids_per_packet) {
+      dynamixel::GroupSyncWrite table_write(port_handler_, packet_handler_, addr, length);
+      for (size_t i = first; i < std::min(first + ids_per_packet, ids.size()); i++) {
+        if (table_write.addParam(ids.at(i), table[ids.at(i)].data()) != true) {
+          fprintf(stderr, "[ID:%03d] Indirect address groupSyncWrite addparam failed\n", ids.at(i));
+          return DxlError::SYNC_WRITE_FAIL;
+        }
+      }
+      int dxl_comm_result = table_write.txPacket();
+      if (dxl_comm_result != COMM_SUCCESS) {
+        fprintf(
+          stderr, "Indirect address SyncWrite Fail - %s\n",
+          packet_handler_->getTxRxResult(dxl_comm_result));
+        return DxlError::SYNC_WRITE_FAIL;
+      }
+    }
+  }
+
+  // a sync write has no status packet, read every table back before it is relied on
+  std::vector<uint8_t> stale_id_arr;
+  DxlError result = FindStaleIndirectAddr(id_arr, indirect_info, addr_item_name, stale_id_arr);
+  if (result != DxlError::OK) {
+    return result;
+  }
+  for (auto it_id : stale_id_arr) {
+    fprintf(stderr, "[ID:%03d] %s still stale after the write\n", it_id, addr_item_name.c_str());
+  }
+  if (!stale_id_arr.empty()) {
+    return DxlError::INDIRECT_ADDR_FAIL;
+  }
+  fprintf(
+    stderr, "%s : %zu tables written in %zu groups and verified\n", addr_item_name.c_str(),
+    table.size(), table_group.size());
+  return DxlError::OK;
+}
+
+DxlError Dynamixel::UpdateIndirectAddr(
+  const std::vector<uint8_t> & id_arr,
+  const std::map<uint8_t, IndirectInfo> & indirect_info,
+  const std::string & addr_item_name)
+{
+  std::vector<uint8_t> stale_id_arr;
+  DxlError result = FindStaleIndirectAddr(id_arr, indirect_info, addr_item_name, stale_id_arr);
+  if (result != DxlError::OK) {
+    return result;
+  }
+
+  // torque is kept on IDs whose table matches, so pick up what a previous run left enabled
+  for (auto it_id : id_arr) {
+    uint32_t torque_enable = 0;
+    if (torque_state_.count(it_id) &&
+      std::find(stale_id_arr.begin(), stale_id_arr.end(), it_id) == stale_id_arr.end() &&
+      ReadItem(it_id, "Torque Enable", torque_enable) == DxlError::OK)
+    {
+      torque_state_[it_id] = torque_enable ? TORQUE_ON : TORQUE_OFF;
+    }
+  }
+  if (stale_id_arr.empty()) {
+    fprintf(stderr, "%s : every table already matches, torque kept\n", addr_item_name.c_str());
+    return DxlError::OK;
+  }
+
+  // the address table is writable with torque off only. torque_state_ starts as off,
+  // so a servo still enabled by a previous run is switched off explicitly.
+  for (auto it_id : stale_id_arr) {
+    if (WriteItem(it_id, "Torque Enable", TORQUE_OFF) != DxlError::OK) {
+      fprintf(stderr, "[ID:%03d] Cannot write \"Torque Off\" command!\n", it_id);
+      return DxlError::ITEM_WRITE_FAIL;
+    }
+    torque_state_[it_id] = TORQUE_OFF;
+    fprintf(stderr, "[ID:%03d] Torque OFF, %s is rewritten\n", it_id, addr_item_name.c_str());
+  }
+  return WriteIndirectAddr(stale_id_arr, indirect_info, addr_item_name);
+}
+
+DxlError Dynamixel::FindStaleIndirectAddr(
+  const std::vector<uint8_t> & id_arr,
+  const std::map<uint8_t, IndirectInfo> & indirect_info,
+  const std::string & addr_item_name,
+  std::vector<uint8_t> & stale_id_arr)
+{
+  FinishReadRequest();
+  stale_id_arr.clear();
+
+  // read back the address table of every ID in one bulk read
+  std::map<uint8_t, uint16_t> table_addr;
+  dynamixel::GroupBulkRead table_read(port_handler_, packet_handler_);
+  for (auto it_id : id_arr) {
+    auto it = indirect_info.find(it_id);
+    if (it == indirect_info.end() || it->second.addr_table.empty() || table_addr.count(it_id) ||
+      std::find(stale_id_arr.begin(), stale_id_arr.end(), it_id) != stale_id_arr.end())
+    {
+      continue;
+    }
+    uint16_t INDIRECT_ADDR;
+    uint8_t INDIRECT_SIZE;
+    if (dxl_info_.GetDxlControlItem(
+        it_id, addr_item_name, INDIRECT_ADDR, INDIRECT_SIZE) == false)
+    {
+      return DxlError::CANNOT_FIND_CONTROL_ITEM;
+    }
+    if (!table_read.addParam(it_id, INDIRECT_ADDR, it->second.addr_table.size() * 2)) {
+      // cannot be read back, so it cannot be trusted either
+      fprintf(stderr, "[ID:%03d] %s BulkRead addParam failed\n", it_id, addr_item_name.c_str());
+      stale_id_arr.push_back(it_id);
+      continue;
+    }
+    table_addr[it_id] = INDIRECT_ADDR;
+  }
+  if (table_addr.empty()) {
+    return DxlError::OK;
+  }
+
+  int dxl_comm_result = table_read.txRxPacket();
+  if (dxl_comm_result != COMM_SUCCESS) {
+    fprintf(
+      stderr, "%s BulkRead Fail - %s, rewriting every table\n", addr_item_name.c_str(),
+      packet_handler_->getTxRxResult(dxl_comm_result));
+    for (const auto & it : table_addr) {
+      stale_id_arr.push_back(it.first);
+    }
+    return DxlError::OK;
+  }
+
+  for (const auto & it : table_addr) {
+    const std::vector<uint16_t> & addr_table = indirect_info.at(it.first).addr_table;
+    for (size_t i = 0; i < addr_table.size(); i++) {
+      if (table_read.getData(it.first, it.second + i * 2, 2) != addr_table.at(i)) {
+        stale_id_arr.push_back(it.first);
+        break;
+      }
+    }
+  }
+  return DxlError::OK;
+}
 }  // namespace dynamixel_hardware_interface
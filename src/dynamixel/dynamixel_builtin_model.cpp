@@ -0,0 +1,39 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#include "dynamixel_hardware_interface/dynamixel/dynamixel_info.hpp"
+
+// generated by dxl_model_converter --header from param/dxl_model
+#include "dynamixel_hardware_interface/dynamixel/dxl_builtin_model_table.hpp"
+
+namespace dynamixel_hardware_interface
+{
+
+  const BuiltinDxlModel* FindBuiltinDxlModel(uint16_t model_num)
+  {
+    for (size_t i = 0; i < BUILTIN_DXL_MODEL_CNT; i++) {
+      if (BUILTIN_DXL_MODEL[i].model_num == model_num) {
+        return &BUILTIN_DXL_MODEL[i];
+      }
+    }
+    return nullptr;
+  }
+
+  size_t GetBuiltinDxlModelCount()
+  {
+    return BUILTIN_DXL_MODEL_CNT;
+  }
+}  // namespace dynamixel_hardware_interface
@@ -32,6 +32,12 @@ namespace dynamixel_hardware_interface
     std::string model_file = dxl_model_file_dir + "/dynamixel.model";
     std::ifstream open_file(model_file.c_str());
     if (open_file.is_open() != 1) {
+      if (GetBuiltinDxlModelCount() > 0) {
+        fprintf(
+          stderr, "[WARN] CANNOT FIND DXL MODEL LIST FILE, ONLY BUILTIN MODELS ARE AVAILABLE.\n%s\n",
+          model_file.c_str());
+        return;
+      }
       fprintf(stderr, "[ERROR] CANNOT FIND DXL MODEL LIST FILE.\n%s\n", model_file.c_str());
       exit(-1);
     }
@@ -53,100 +59,94 @@ namespace dynamixel_hardware_interface
 
   void DynamixelInfo::ReadDxlModelFile(uint8_t id, uint16_t model_num)
   {
-    std::string path = dxl_model_file_dir + "/";
-
-    auto it = dxl_model_list_.find(model_num);
-    if (it != dxl_model_list_.end()) {
-      path += it->second;
-    }
-    else {
-      fprintf(stderr, "[ERROR] CANNOT FIND THE DXL MODEL FROM FILE LIST.\n");
+    auto cached = dxl_model_cache_.find(model_num);
+    if (cached != dxl_model_cache_.end()) {
+      dxl_info_[id] = cached->second;
       return;
     }
 
-    std::ifstream open_file(path);
-    if (open_file.is_open() != 1) {
-      fprintf(stderr, "[ERROR] CANNOT FIND DXL [%s] MODEL FILE.\n", path.c_str());
-      exit(-1);
-    }
-
-    DxlInfo temp_dxl_info;
-    std::string line;
-
-    temp_dxl_info.model_num = model_num;
-
-    while (!open_file.eof()) {
-      getline(open_file, line);
-      if (strcmp(line.c_str(), "[control table]") == 0) {
-        break;
+    std::shared_ptr<DxlInfo> dxl_info = std::make_shared<DxlInfo>();
+
+    // models compiled into the library need no file, the model files are the fallback
+    const BuiltinDxlModel* builtin = FindBuiltinDxlModel(model_num);
+    if (builtin != nullptr) {
+      dxl_info->torque_constant = builtin->torque_constant;
+      dxl_info->min_radian = builtin->min_radian;
+      dxl_info->max_radian = builtin->max_radian;
+      dxl_info->value_of_zero_radian_position = builtin->value_of_zero_radian_position;
+      dxl_info->value_of_max_radian_position = builtin->value_of_max_radian_position;
+      dxl_info->value_of_min_radian_position = builtin->value_of_min_radian_position;
+      dxl_info->item.reserve(builtin->item_cnt);
+      for (size_t i = 0; i < builtin->item_cnt; i++) {
+        ControlItem temp;
+        temp.address = builtin->item[i].address;
+        temp.size = builtin->item[i].size;
+        temp.item_name = builtin->item[i].item_name;
+        dxl_info->item.push_back(temp);
       }
+    }
+    else {
+      std::string path = dxl_model_file_dir + "/";
 
-      std::vector<std::string> strs;
-      boost::split(strs, line, boost::is_any_of("\t"));
-
-      if (strs.at(0) == "value_of_zero_radian_position") {
-        temp_dxl_info.value_of_zero_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
-      }
-      else if (strs.at(0) == "value_of_max_radian_position") {
-        temp_dxl_info.value_of_max_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
+      auto it = dxl_model_list_.find(model_num);
+      if (it != dxl_model_list_.end()) {
+        path += it->second;
       }
-      else if (strs.at(0) == "value_of_min_radian_position") {
-        temp_dxl_info.value_of_min_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
+      else {
+        fprintf(stderr, "[ERROR] CANNOT FIND THE DXL MODEL FROM FILE LIST.\n");
+        return;
       }
-      else if (strs.at(0) == "min_radian") {
-        temp_dxl_info.min_radian = static_cast<double>(stod(strs.at(1)));
-      }
-      else if (strs.at(0) == "max_radian") {
-        temp_dxl_info.max_radian = static_cast<double>(stod(strs.at(1)));
-      }
-      else if (strs.at(0) == "torque_constant") {
-        temp_dxl_info.torque_constant = static_cast<double>(stod(strs.at(1)));
+
+      // the binary generated at build time is preferred, the text file is the fallback
+      if (!ReadDxlModelBinary(path + ".bin", *dxl_info) && !ReadDxlModelText(path, *dxl_info)) {
+        fprintf(stderr, "[ERROR] CANNOT FIND DXL [%s] MODEL FILE.\n", path.c_str());
+        exit(-1);
       }
     }
+    dxl_info->model_num = model_num;
 
-    getline(open_file, line);
-    while (!open_file.eof()) {
-      getline(open_file, line);
-      if (!open_file.good()) {
-        break;
-      }
+    dxl_info->item_index.reserve(dxl_info->item.size());
+    for (const auto& item : dxl_info->item) {
+      dxl_info->item_index.insert(std::make_pair(item.item_name, item));
+    }
 
-      std::vector<std::string> strs;
-      boost::split(strs, line, boost::is_any_of("\t"));
+    dxl_model_cache_[model_num] = dxl_info;
+    dxl_info_[id] = dxl_info;
+  }
 
-      ControlItem temp;
-      temp.address = static_cast<uint16_t>(stoi(strs.at(0)));
-      temp.size = static_cast<uint8_t>(stoi(strs.at(1)));
-      temp.item_name = strs.at(2);
-      temp_dxl_info.item.push_back(temp);
+  const DxlInfo* DynamixelInfo::FindDxlInfo(uint8_t id) const
+  {
+    auto it = dxl_info_.find(id);
+    if (it == dxl_info_.end()) {
+      return nullptr;
     }
-
-    dxl_info_[id] = temp_dxl_info;
-    open_file.close();
+    return it->second.get();
   }
 
   bool DynamixelInfo::GetDxlControlItem(
-    uint8_t id, std::string item_name, uint16_t& addr,
-    uint8_t& size)
+    uint8_t id, const std::string& item_name, uint16_t& addr,
+    uint8_t& size) const
   {
-    for (size_t i = 0; i < dxl_info_[id].item.size(); i++) {
-      if (strcmp(item_name.c_str(), dxl_info_[id].item.at(i).item_name.c_str()) == 0) {
-        addr = dxl_info_[id].item.at(i).address;
-        size = dxl_info_[id].item.at(i).size;
-        return true;
-      }
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return false;
+    }
+    auto it = info->item_index.find(item_name);
+    if (it == info->item_index.end()) {
+      return false;
     }
-    return false;
+    addr = it->second.address;
+    size = it->second.size;
+    return true;
   }
 
-  bool DynamixelInfo::CheckDxlControlItem(uint8_t id, std::string item_name)
+  bool DynamixelInfo::CheckDxlControlItem(uint8_t id, const std::string& item_name) const
   {
-    for (size_t i = 0; i < dxl_info_[id].item.size(); i++) {
-      if (strcmp(item_name.c_str(), dxl_info_[id].item.at(i).item_name.c_str()) == 0) {
-        return true;
-      }
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return false;
     }
-    return false;
+    return info->item_index.find(item_name) != info->item_index.end();
   }
 
   bool DynamixelInfo::GetDxlTypeInfo(
@@ -155,48 +155,70 @@ namespace dynamixel_hardware_interface
     int32_t& value_of_max_radian_position,
     int32_t& value_of_min_radian_position,
     double& min_radian,
-    double& max_radian)
+    double& max_radian) const
   {
-    value_of_zero_radian_position = dxl_info_[id].value_of_zero_radian_position;
-    value_of_max_radian_position = dxl_info_[id].value_of_max_radian_position;
-    value_of_min_radian_position = dxl_info_[id].value_of_min_radian_position;
-    min_radian = dxl_info_[id].min_radian;
-    max_radian = dxl_info_[id].max_radian;
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return false;
+    }
+    value_of_zero_radian_position = info->value_of_zero_radian_position;
+    value_of_max_radian_position = info->value_of_max_radian_position;
+    value_of_min_radian_position = info->value_of_min_radian_position;
+    min_radian = info->min_radian;
+    max_radian = info->max_radian;
+    return true;
+  }
+
+  bool DynamixelInfo::GetDxlTorqueConstant(uint8_t id, double& torque_constant) const
+  {
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return false;
+    }
+    torque_constant = info->torque_constant;
     return true;
   }
 
-  int32_t DynamixelInfo::ConvertRadianToValue(uint8_t id, double radian)
+  int32_t DynamixelInfo::ConvertRadianToValue(uint8_t id, double radian) const
   {
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return 0;
+    }
     if (radian > 0) {
       return static_cast<int32_t>(radian *
-        (dxl_info_[id].value_of_max_radian_position -
-          dxl_info_[id].value_of_zero_radian_position) / dxl_info_[id].max_radian) +
-        dxl_info_[id].value_of_zero_radian_position;
+        (info->value_of_max_radian_position -
+          info->value_of_zero_radian_position) / info->max_radian) +
+        info->value_of_zero_radian_position;
     }
     else if (radian < 0) {
       return static_cast<int32_t>(radian *
-        (dxl_info_[id].value_of_min_radian_position -
-          dxl_info_[id].value_of_zero_radian_position) / dxl_info_[id].min_radian) +
-        dxl_info_[id].value_of_zero_radian_position;
+        (info->value_of_min_radian_position -
+          info->value_of_zero_radian_position) / info->min_radian) +
+        info->value_of_zero_radian_position;
     }
     else {
-      return dxl_info_[id].value_of_zero_radian_position;
+      return info->value_of_zero_radian_position;
     }
   }
 
-  double DynamixelInfo::ConvertValueToRadian(uint8_t id, int32_t value)
+  double DynamixelInfo::ConvertValueToRadian(uint8_t id, int32_t value) const
   {
-    if (value > dxl_info_[id].value_of_zero_radian_position) {
-      return static_cast<double>(value - dxl_info_[id].value_of_zero_radian_position) *
-        dxl_info_[id].max_radian /
-        static_cast<double>(dxl_info_[id].value_of_max_radian_position -
-          dxl_info_[id].value_of_zero_radian_position);
-    }
-    else if (value < dxl_info_[id].value_of_zero_radian_position) {
-      return static_cast<double>(value - dxl_info_[id].value_of_zero_radian_position) *
-        dxl_info_[id].min_radian /
-        static_cast<double>(dxl_info_[id].value_of_min_radian_position -
-          dxl_info_[id].value_of_zero_radian_position);
+    const DxlInfo* info = FindDxlInfo(id);
+    if (info == nullptr) {
+      return 0.0;
+    }
+    if (value > info->value_of_zero_radian_position) {
+      return static_cast<double>(value - info->value_of_zero_radian_position) *
+        info->max_radian /
+        static_cast<double>(info->value_of_max_radian_position -
+          info->value_of_zero_radian_position);
+    }
+    else if (value < info->value_of_zero_radian_position) {
+      return static_cast<double>(value - info->value_of_zero_radian_position) *
+        info->min_radian /
+        static_cast<double>(info->value_of_min_radian_position -
+          info->value_of_zero_radian_position);
     }
     else {
       return 0.0;
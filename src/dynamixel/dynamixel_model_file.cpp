@@ -0,0 +1,195 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#include "dynamixel_hardware_interface/dynamixel/dynamixel_info.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace dynamixel_hardware_interface
+{
+
+  bool DynamixelInfo::ReadDxlModelText(const std::string& path, DxlInfo& dxl_info)
+  {
+    std::ifstream open_file(path);
+    if (open_file.is_open() != 1) {
+      return false;
+    }
+
+    std::string line;
+    while (!open_file.eof()) {
+      getline(open_file, line);
+      if (strcmp(line.c_str(), "[control table]") == 0) {
+        break;
+      }
+
+      std::vector<std::string> strs;
+      boost::split(strs, line, boost::is_any_of("\t"));
+
+      if (strs.at(0) == "value_of_zero_radian_position") {
+        dxl_info.value_of_zero_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
+      }
+      else if (strs.at(0) == "value_of_max_radian_position") {
+        dxl_info.value_of_max_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
+      }
+      else if (strs.at(0) == "value_of_min_radian_position") {
+        dxl_info.value_of_min_radian_position = static_cast<int32_t>(stoi(strs.at(1)));
+      }
+      else if (strs.at(0) == "min_radian") {
+        dxl_info.min_radian = static_cast<double>(stod(strs.at(1)));
+      }
+      else if (strs.at(0) == "max_radian") {
+        dxl_info.max_radian = static_cast<double>(stod(strs.at(1)));
+      }
+      else if (strs.at(0) == "torque_constant") {
+        dxl_info.torque_constant = static_cast<double>(stod(strs.at(1)));
+      }
+    }
+
+    getline(open_file, line);
+    while (!open_file.eof()) {
+      getline(open_file, line);
+      if (!open_file.good()) {
+        break;
+      }
+
+      std::vector<std::string> strs;
+      boost::split(strs, line, boost::is_any_of("\t"));
+
+      ControlItem temp;
+      temp.address = static_cast<uint16_t>(stoi(strs.at(0)));
+      temp.size = static_cast<uint8_t>(stoi(strs.at(1)));
+      temp.item_name = strs.at(2);
+      dxl_info.item.push_back(temp);
+    }
+
+    open_file.close();
+    return true;
+  }
+
+  bool DynamixelInfo::ReadDxlModelBinary(const std::string& path, DxlInfo& dxl_info)
+  {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(DxlModelBinHeader))
+    {
+      close(fd);
+      return false;
+    }
+    size_t file_size = static_cast<size_t>(file_stat.st_size);
+    void* map = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(map);
+    const DxlModelBinHeader* header = reinterpret_cast<const DxlModelBinHeader*>(data);
+    size_t items_end = sizeof(DxlModelBinHeader) +
+      static_cast<size_t>(header->item_count) * sizeof(DxlModelBinItem);
+    if (memcmp(header->magic, DXL_MODEL_BIN_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != DXL_MODEL_BIN_VERSION ||
+      items_end + header->name_table_size != file_size)
+    {
+      fprintf(stderr, "[WARN] INVALID DXL MODEL BINARY [%s], USING THE TEXT FILE.\n", path.c_str());
+      munmap(map, file_size);
+      return false;
+    }
+
+    dxl_info.torque_constant = header->torque_constant;
+    dxl_info.min_radian = header->min_radian;
+    dxl_info.max_radian = header->max_radian;
+    dxl_info.value_of_zero_radian_position = header->value_of_zero_radian_position;
+    dxl_info.value_of_max_radian_position = header->value_of_max_radian_position;
+    dxl_info.value_of_min_radian_position = header->value_of_min_radian_position;
+
+    // the records and names are copied out of the mapping, which is released right after
+    const DxlModelBinItem* bin_item =
+      reinterpret_cast<const DxlModelBinItem*>(data + sizeof(DxlModelBinHeader));
+    const char* name_table = reinterpret_cast<const char*>(data + items_end);
+    dxl_info.item.reserve(header->item_count);
+    for (uint32_t i = 0; i < header->item_count; i++) {
+      if (static_cast<size_t>(bin_item[i].name_offset) + bin_item[i].name_length >
+        header->name_table_size)
+      {
+        fprintf(stderr, "[WARN] INVALID DXL MODEL BINARY [%s], USING THE TEXT FILE.\n", path.c_str());
+        dxl_info.item.clear();
+        munmap(map, file_size);
+        return false;
+      }
+      ControlItem temp;
+      temp.address = bin_item[i].address;
+      temp.size = bin_item[i].size;
+      temp.item_name.assign(name_table + bin_item[i].name_offset, bin_item[i].name_length);
+      dxl_info.item.push_back(temp);
+    }
+
+    munmap(map, file_size);
+    return true;
+  }
+
+  bool DynamixelInfo::WriteDxlModelBinary(const std::string& path, const DxlInfo& dxl_info)
+  {
+    DxlModelBinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DXL_MODEL_BIN_MAGIC, sizeof(header.magic));
+    header.version = DXL_MODEL_BIN_VERSION;
+    header.item_count = static_cast<uint32_t>(dxl_info.item.size());
+    header.torque_constant = dxl_info.torque_constant;
+    header.min_radian = dxl_info.min_radian;
+    header.max_radian = dxl_info.max_radian;
+    header.value_of_zero_radian_position = dxl_info.value_of_zero_radian_position;
+    header.value_of_max_radian_position = dxl_info.value_of_max_radian_position;
+    header.value_of_min_radian_position = dxl_info.value_of_min_radian_position;
+
+    std::vector<DxlModelBinItem> bin_items;
+    std::string name_table;
+    for (const auto& item : dxl_info.item) {
+      if (item.item_name.size() > UINT8_MAX) {
+        fprintf(stderr, "[ERROR] DXL ITEM NAME TOO LONG [%s].\n", item.item_name.c_str());
+        return false;
+      }
+      DxlModelBinItem bin_item;
+      memset(&bin_item, 0, sizeof(bin_item));
+      bin_item.address = item.address;
+      bin_item.size = item.size;
+      bin_item.name_length = static_cast<uint8_t>(item.item_name.size());
+      bin_item.name_offset = static_cast<uint32_t>(name_table.size());
+      name_table += item.item_name;
+      bin_items.push_back(bin_item);
+    }
+    header.name_table_size = static_cast<uint32_t>(name_table.size());
+
+    std::ofstream out_file(path, std::ios::binary | std::ios::trunc);
+    if (!out_file.is_open()) {
+      return false;
+    }
+    out_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out_file.write(
+      reinterpret_cast<const char*>(bin_items.data()), bin_items.size() * sizeof(DxlModelBinItem));
+    out_file.write(name_table.data(), name_table.size());
+    return out_file.good();
+  }
+}  // namespace dynamixel_hardware_interface
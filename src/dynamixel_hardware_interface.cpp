@@ -16,10 +16,15 @@
 
 #include "dynamixel_hardware_interface/dynamixel_hardware_interface.hpp"
 
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <sstream>
 #include <vector>
 #include <string>
 
@@ -29,6 +34,142 @@
 namespace dynamixel_hardware_interface
 {
 
+  namespace
+  {
+    // points the values of every handler into storage, keeping their current values
+    void AssignValueStorage(std::vector<HandlerVarType>& hdl, HandlerValueStorage& storage)
+    {
+      std::vector<size_t> value_cnt;
+      for (const auto& it : hdl) {
+        value_cnt.push_back(it.value_ptr_vec.size());
+      }
+      storage.Allocate(value_cnt);
+      for (size_t i = 0; i < hdl.size(); i++) {
+        for (size_t j = 0; j < hdl.at(i).value_ptr_vec.size(); j++) {
+          double* value = storage.Column(j) + i;
+          if (hdl.at(i).value_ptr_vec.at(j) != nullptr) {
+            *value = *hdl.at(i).value_ptr_vec.at(j);
+          }
+          hdl.at(i).value_ptr_vec.at(j) = value;
+        }
+      }
+    }
+
+    // same layout as src, with values of its own in storage
+    std::vector<HandlerVarType> CloneHandler(
+      const std::vector<HandlerVarType>& src, HandlerValueStorage& storage)
+    {
+      std::vector<HandlerVarType> dst = src;
+      AssignValueStorage(dst, storage);
+      return dst;
+    }
+
+    size_t CountValues(const std::vector<HandlerVarType>& hdl)
+    {
+      size_t count = 0;
+      for (const auto& it : hdl) {
+        count += it.value_ptr_vec.size();
+      }
+      return count;
+    }
+
+    size_t CopyToSnapshot(
+      const std::vector<HandlerVarType>& hdl, std::vector<double>& snapshot, size_t index)
+    {
+      for (const auto& it : hdl) {
+        for (const auto& value : it.value_ptr_vec) {
+          snapshot[index++] = *value;
+        }
+      }
+      return index;
+    }
+
+    size_t CopyFromSnapshot(
+      const std::vector<double>& snapshot, size_t index, const std::vector<HandlerVarType>& hdl)
+    {
+      for (const auto& it : hdl) {
+        for (const auto& value : it.value_ptr_vec) {
+          *value = snapshot[index++];
+        }
+      }
+      return index;
+    }
+
+    std::vector<std::string> SplitParam(const std::string& param)
+    {
+      std::vector<std::string> values;
+      std::stringstream ss(param);
+      std::string str;
+      while (std::getline(ss, str, ',')) {
+        str.erase(0, str.find_first_not_of(" \t\n"));
+        str.erase(str.find_last_not_of(" \t\n") + 1);
+        if (!str.empty()) {
+          values.push_back(str);
+        }
+      }
+      return values;
+    }
+
+    const char* const LATENCY_PHASE_NAME[LATENCY_PHASE_COUNT] = {
+      "read_txrx", "read_decode", "read_item_buf", "bus_write",
+      "calc_transmission_to_joint", "state_publish", "service_request", "torque_change",
+      "calc_joint_to_transmission", "read", "write", "cycle"
+    };
+
+    // Hardware Error Status bits that put the servo into HW_ERROR
+    const uint8_t HW_ERROR_INPUT_VOLTAGE = 0x01;
+    const uint8_t HW_ERROR_OVERHEATING = 0x04;
+    const uint8_t HW_ERROR_MOTOR_ENCODER = 0x08;
+    const uint8_t HW_ERROR_ELECTRICAL_SHOCK = 0x10;
+    const uint8_t HW_ERROR_OVERLOAD = 0x20;
+    const uint8_t HW_ERROR_MASK = HW_ERROR_INPUT_VOLTAGE | HW_ERROR_OVERHEATING |
+      HW_ERROR_MOTOR_ENCODER | HW_ERROR_ELECTRICAL_SHOCK | HW_ERROR_OVERLOAD;
+
+    const std::chrono::milliseconds LOG_DRAIN_PERIOD(100);
+
+    // shorter than the 1 s the service callbacks wait, so they still get the answer
+    const std::chrono::milliseconds SERVICE_REQUEST_DEADLINE(500);
+
+    // I/O cycles without a fresh state snapshot before read() reports a comm error
+    const int IO_STATE_STALE_CYCLES = 5;
+    // floor of the limit, for back to back cycles whose length is unknown
+    const std::chrono::milliseconds IO_STATE_STALE_MIN(20);
+
+    std::string HardwareErrorToString(uint8_t err)
+    {
+      std::string error_string = "";
+      if (err & HW_ERROR_INPUT_VOLTAGE) {
+        error_string += "input voltage error/ ";
+      }
+      if (err & HW_ERROR_OVERHEATING) {
+        error_string += "overheating/ ";
+      }
+      if (err & HW_ERROR_MOTOR_ENCODER) {
+        error_string += "motor encoder/ ";
+      }
+      if (err & HW_ERROR_ELECTRICAL_SHOCK) {
+        error_string += "electrical shock/ ";
+      }
+      if (err & HW_ERROR_OVERLOAD) {
+        error_string += "Overload/ ";
+      }
+      if (error_string.empty()) {
+        error_string = "cleared";
+      }
+      return error_string;
+    }
+
+    void CopyHandlerValues(
+      const std::vector<HandlerVarType>& src, const std::vector<HandlerVarType>& dst)
+    {
+      for (size_t i = 0; i < src.size(); i++) {
+        for (size_t j = 0; j < src.at(i).value_ptr_vec.size(); j++) {
+          *dst.at(i).value_ptr_vec.at(j) = *src.at(i).value_ptr_vec.at(j);
+        }
+      }
+    }
+  }  // namespace
+
   DynamixelHardware::DynamixelHardware()
     : rclcpp::Node("dynamixel_hardware_interface"),
     logger_(rclcpp::get_logger("dynamixel_hardware_interface"))
@@ -44,7 +185,9 @@ namespace dynamixel_hardware_interface
 
   DynamixelHardware::~DynamixelHardware()
   {
+    StopExecutor();
     stop();
+    StopLogThread();
 
     if (rclcpp::ok()) {
       RCLCPP_INFO(logger_, "Shutting down ROS2 node...");
@@ -64,10 +207,19 @@ namespace dynamixel_hardware_interface
     num_of_joints_ = static_cast<size_t>(stoi(info_.hardware_parameters["number_of_joints"]));
     num_of_transmissions_ =
       static_cast<size_t>(stoi(info_.hardware_parameters["number_of_transmissions"]));
-    SetMatrix();
+    if (!SetMatrix()) {
+      return hardware_interface::CallbackReturn::ERROR;
+    }
 
-    port_name_ = info_.hardware_parameters["port_name"];
-    baud_rate_ = info_.hardware_parameters["baud_rate"];
+    std::vector<std::string> port_names = SplitParam(info_.hardware_parameters["port_name"]);
+    std::vector<std::string> baud_rates = SplitParam(info_.hardware_parameters["baud_rate"]);
+    if (port_names.empty() || baud_rates.empty() ||
+      (baud_rates.size() != 1 && baud_rates.size() != port_names.size()))
+    {
+      RCLCPP_ERROR_STREAM(
+        logger_, "Error: port_name needs at least one port and baud_rate one value or one per port");
+      return hardware_interface::CallbackReturn::ERROR;
+    }
     try {
       err_timeout_ms_ = stod(info_.hardware_parameters["error_timeout_ms"]);
     }
@@ -75,25 +227,177 @@ namespace dynamixel_hardware_interface
       RCLCPP_ERROR(logger_, "Failed to parse error_timeout_ms parameter: %s, using default value", e.what());
     }
 
-    RCLCPP_INFO_STREAM(
-      logger_,
-      "port_name " << port_name_.c_str() << " / baudrate " << baud_rate_.c_str());
+    bool use_fast_read = false;
+    if (info_.hardware_parameters.find("use_fast_read") != info_.hardware_parameters.end()) {
+      use_fast_read = info_.hardware_parameters.at("use_fast_read") == "true";
+      RCLCPP_INFO_STREAM(logger_, "use_fast_read " << (use_fast_read ? "true" : "false"));
+    }
+
+    if (info_.hardware_parameters.find("use_pipelined_read") != info_.hardware_parameters.end()) {
+      use_pipelined_read_ = info_.hardware_parameters.at("use_pipelined_read") == "true";
+      RCLCPP_INFO_STREAM(
+        logger_, "use_pipelined_read " << (use_pipelined_read_ ? "true" : "false"));
+    }
+
+    if (info_.hardware_parameters.find("use_io_thread") != info_.hardware_parameters.end()) {
+      use_io_thread_ = info_.hardware_parameters.at("use_io_thread") == "true";
+      RCLCPP_INFO_STREAM(logger_, "use_io_thread " << (use_io_thread_ ? "true" : "false"));
+    }
+
+    std::vector<std::string> thread_cpus;
+    if (info_.hardware_parameters.find("io_thread_cpu") != info_.hardware_parameters.end()) {
+      thread_cpus = SplitParam(info_.hardware_parameters.at("io_thread_cpu"));
+    }
+
+    if (info_.hardware_parameters.find("io_thread_rate_hz") != info_.hardware_parameters.end()) {
+      try {
+        io_thread_rate_hz_ = stod(info_.hardware_parameters.at("io_thread_rate_hz"));
+      }
+      catch (const std::exception& e) {
+        RCLCPP_ERROR(logger_, "Failed to parse io_thread_rate_hz parameter: %s, using default value", e.what());
+      }
+    }
+
+    bool optimize_bus_timing = false;
+    std::vector<std::string> target_baud_rates;
+    if (info_.hardware_parameters.find("optimize_bus_timing") != info_.hardware_parameters.end()) {
+      optimize_bus_timing = info_.hardware_parameters.at("optimize_bus_timing") == "true";
+      RCLCPP_INFO_STREAM(
+        logger_, "optimize_bus_timing " << (optimize_bus_timing ? "true" : "false"));
+    }
+    if (optimize_bus_timing &&
+      info_.hardware_parameters.find("target_baud_rate") != info_.hardware_parameters.end())
+    {
+      target_baud_rates = SplitParam(info_.hardware_parameters.at("target_baud_rate"));
+      if (target_baud_rates.size() > 1 && target_baud_rates.size() != port_names.size()) {
+        RCLCPP_ERROR_STREAM(
+          logger_, "Error: target_baud_rate needs one value or one per port");
+        return hardware_interface::CallbackReturn::ERROR;
+      }
+    }
+
+    bool use_write_elision = false;
+    uint32_t write_deadband = 0;
+    uint32_t write_refresh_cycles = 100;
+    if (info_.hardware_parameters.find("use_write_elision") != info_.hardware_parameters.end()) {
+      use_write_elision = info_.hardware_parameters.at("use_write_elision") == "true";
+      RCLCPP_INFO_STREAM(
+        logger_, "use_write_elision " << (use_write_elision ? "true" : "false"));
+    }
+    try {
+      if (info_.hardware_parameters.find("write_deadband") != info_.hardware_parameters.end()) {
+        write_deadband =
+          static_cast<uint32_t>(stoul(info_.hardware_parameters.at("write_deadband")));
+      }
+      if (info_.hardware_parameters.find("write_refresh_cycles") !=
+        info_.hardware_parameters.end())
+      {
+        write_refresh_cycles =
+          static_cast<uint32_t>(stoul(info_.hardware_parameters.at("write_refresh_cycles")));
+      }
+    }
+    catch (const std::exception& e) {
+      RCLCPP_ERROR(logger_, "Failed to parse write elision parameters: %s, using default value", e.what());
+    }
+
+    if (info_.hardware_parameters.find("use_latency_stats") != info_.hardware_parameters.end()) {
+      use_latency_stats_ = info_.hardware_parameters.at("use_latency_stats") == "true";
+      RCLCPP_INFO_STREAM(
+        logger_, "use_latency_stats " << (use_latency_stats_ ? "true" : "false"));
+    }
+    if (info_.hardware_parameters.find("latency_stats_period_ms") !=
+      info_.hardware_parameters.end())
+    {
+      try {
+        latency_stats_period_ = std::chrono::milliseconds(
+          stoi(info_.hardware_parameters.at("latency_stats_period_ms")));
+      }
+      catch (const std::exception& e) {
+        RCLCPP_ERROR(logger_, "Failed to parse latency_stats_period_ms parameter: %s, using default value", e.what());
+      }
+    }
+
+    std::chrono::milliseconds log_rate_limit(1000);
+    if (info_.hardware_parameters.find("log_rate_limit_ms") != info_.hardware_parameters.end()) {
+      try {
+        log_rate_limit = std::chrono::milliseconds(
+          stoi(info_.hardware_parameters.at("log_rate_limit_ms")));
+      }
+      catch (const std::exception& e) {
+        RCLCPP_ERROR(logger_, "Failed to parse log_rate_limit_ms parameter: %s, using default value", e.what());
+      }
+    }
+    log_ring_.SetInterval(log_rate_limit);
+    StartLogThread();
+
+    // builtin models need no share directory, model files there are only the fallback
+    std::string dxl_model_path;
+    try {
+      dxl_model_path = ament_index_cpp::get_package_share_directory("dynamixel_hardware_interface") +
+        info_.hardware_parameters["dynamixel_model_folder"];
+    }
+    catch (const std::exception& e) {
+      RCLCPP_WARN(logger_, "Cannot find the package share directory: %s, using builtin models only", e.what());
+    }
+    ports_.clear();
+    for (size_t i = 0; i < port_names.size(); i++) {
+      std::unique_ptr<DxlPortType> port(new DxlPortType());
+      port->port_name = port_names.at(i);
+      port->baud_rate = baud_rates.size() == 1 ? baud_rates.at(0) : baud_rates.at(i);
+      if (!target_baud_rates.empty()) {
+        port->target_baud_rate =
+          target_baud_rates.size() == 1 ? target_baud_rates.at(0) : target_baud_rates.at(i);
+      }
+      if (i < thread_cpus.size()) {
+        try {
+          port->cpu = stoi(thread_cpus.at(i));
+        }
+        catch (const std::exception& e) {
+          RCLCPP_ERROR(logger_, "Failed to parse io_thread_cpu parameter: %s, using default value", e.what());
+        }
+      }
+      port->dxl_comm = std::make_shared<Dynamixel>(dxl_model_path.c_str());
+      port->dxl_comm->SetFastReadMode(use_fast_read);
+      port->dxl_comm->SetWriteElision(use_write_elision, write_deadband, write_refresh_cycles);
+      port->dxl_comm->SetLogRing(&log_ring_);
 
-    std::string dxl_model_folder = info_.hardware_parameters["dynamixel_model_folder"];
-    dxl_comm_ = std::unique_ptr<Dynamixel>(
-      new Dynamixel(
-        (ament_index_cpp::get_package_share_directory("dynamixel_hardware_interface") +
-          dxl_model_folder).c_str()));
+      RCLCPP_INFO_STREAM(
+        logger_,
+        "port_name " << port->port_name.c_str() << " / baudrate " << port->baud_rate.c_str());
+      ports_.push_back(std::move(port));
+    }
 
     RCLCPP_INFO_STREAM(logger_, "$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$$");
     RCLCPP_INFO_STREAM(logger_, "$$$$$ Init Dxl Comm Port");
 
+    id_to_port_.clear();
     for (const hardware_interface::ComponentInfo& gpio : info_.gpios) {
+      uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
+
+      // GPIOs without a port parameter go to the first port
+      size_t port_index = 0;
+      auto port_param = gpio.parameters.find("port");
+      if (port_param != gpio.parameters.end()) {
+        port_index = ports_.size();
+        for (size_t i = 0; i < ports_.size(); i++) {
+          if (ports_.at(i)->port_name == port_param->second) {
+            port_index = i;
+          }
+        }
+        if (port_index == ports_.size()) {
+          RCLCPP_ERROR_STREAM(
+            logger_, "Error: [" << gpio.name << "] port " << port_param->second <<
+            " is not in port_name");
+          return hardware_interface::CallbackReturn::ERROR;
+        }
+      }
+      id_to_port_[id] = port_index;
+
       if (gpio.parameters.at("type") == "dxl") {
-        dxl_id_.push_back(static_cast<uint8_t>(stoi(gpio.parameters.at("ID"))));
+        ports_.at(port_index)->dxl_id.push_back(id);
       }
       else if (gpio.parameters.at("type") == "sensor") {
-        sensor_id_.push_back(static_cast<uint8_t>(stoi(gpio.parameters.at("ID"))));
+        ports_.at(port_index)->sensor_id.push_back(id);
       }
       else {
         RCLCPP_ERROR_STREAM(logger_, "Invalid DXL / Sensor type");
@@ -101,28 +405,73 @@ namespace dynamixel_hardware_interface
       }
     }
 
-    bool trying_connect = true;
-    int trying_cnt = 60;
-    int cnt = 0;
+    for (auto& port : ports_) {
+      bool trying_connect = true;
+      int trying_cnt = 60;
+      int cnt = 0;
+      // a chain that answers with IDs missing is not waiting for power, retrying does not help
+      int not_found_cnt = 0;
+      int baud_rate_cnt = port->target_baud_rate.empty() ? 1 : 2;
 
-    while (trying_connect) {
-      std::vector<uint8_t> id_arr;
-      for (auto dxl : dxl_id_) {
-        id_arr.push_back(dxl);
-      }
-      for (auto sensor : sensor_id_) {
-        id_arr.push_back(sensor);
-      }
-      if (dxl_comm_->InitDxlComm(id_arr, port_name_, baud_rate_) == DxlError::OK) {
-        RCLCPP_INFO_STREAM(logger_, "Trying to connect to the communication port...");
-        trying_connect = false;
+      while (trying_connect) {
+        std::vector<uint8_t> id_arr;
+        for (auto dxl : port->dxl_id) {
+          id_arr.push_back(dxl);
+        }
+        for (auto sensor : port->sensor_id) {
+          id_arr.push_back(sensor);
+        }
+        // servos tuned by an earlier start already run at the target baud rate
+        std::string baud_rate = port->baud_rate;
+        if (!port->target_baud_rate.empty() && cnt % 2 == 1) {
+          baud_rate = port->target_baud_rate;
+        }
+        DxlError result = port->dxl_comm->InitDxlComm(id_arr, port->port_name, baud_rate);
+        if (result == DxlError::OK) {
+          RCLCPP_INFO_STREAM(logger_, "Trying to connect to the communication port...");
+          port->baud_rate = baud_rate;
+          trying_connect = false;
+        }
+        else if (result == DxlError::DXL_NOT_FOUND && ++not_found_cnt < baud_rate_cnt) {
+          cnt++;
+        }
+        else if (result == DxlError::DXL_NOT_FOUND) {
+          RCLCPP_ERROR_STREAM(
+            logger_, "Error: configured Dynamixel IDs are missing on " << port->port_name);
+          return hardware_interface::CallbackReturn::ERROR;
+        }
+        else {
+          sleep(1);
+          cnt++;
+          if (cnt > trying_cnt) {
+            RCLCPP_ERROR_STREAM(
+              logger_, "Cannot connect communication port " << port->port_name << "! :(");
+            cnt = 0;
+          }
+        }
       }
-      else {
-        sleep(1);
-        cnt++;
-        if (cnt > trying_cnt) {
-          RCLCPP_ERROR_STREAM(logger_, "Cannot connect communication port! :(");
-          cnt = 0;
+
+      if (optimize_bus_timing) {
+        std::vector<uint8_t> id_arr = port->dxl_id;
+        id_arr.insert(id_arr.end(), port->sensor_id.begin(), port->sensor_id.end());
+        int target_baud_rate = port->target_baud_rate.empty() ? 0 : stoi(port->target_baud_rate);
+        std::vector<uint8_t> fail_id_arr;
+        DxlError result = port->dxl_comm->OptimizeBusTiming(id_arr, target_baud_rate, fail_id_arr);
+        // a failed Return Delay Time change keeps a baud rate change that succeeded
+        port->baud_rate = std::to_string(port->dxl_comm->GetBaudRate());
+        if (result == DxlError::OK) {
+          RCLCPP_INFO_STREAM(
+            logger_, "Bus timing optimized on " << port->port_name << " / baudrate " <<
+            port->baud_rate);
+        }
+        else {
+          std::stringstream fail_ids;
+          for (auto id : fail_id_arr) {
+            fail_ids << " " << static_cast<int>(id);
+          }
+          RCLCPP_WARN_STREAM(
+            logger_, "Bus timing optimization failed on " << port->port_name <<
+            " (failed IDs:" << fail_ids.str() << "), baudrate " << port->baud_rate);
         }
       }
     }
@@ -159,13 +508,13 @@ namespace dynamixel_hardware_interface
       temp_state.name = joint.name;
 
       temp_state.interface_name_vec.push_back(hardware_interface::HW_IF_POSITION);
-      temp_state.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+      temp_state.value_ptr_vec.push_back(nullptr);
 
       temp_state.interface_name_vec.push_back(hardware_interface::HW_IF_VELOCITY);
-      temp_state.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+      temp_state.value_ptr_vec.push_back(nullptr);
 
       temp_state.interface_name_vec.push_back(hardware_interface::HW_IF_EFFORT);
-      temp_state.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+      temp_state.value_ptr_vec.push_back(nullptr);
 
       for (auto it : joint.state_interfaces) {
         if (hardware_interface::HW_IF_POSITION != it.name &&
@@ -186,11 +535,12 @@ namespace dynamixel_hardware_interface
           RCLCPP_ERROR_STREAM(
             logger_, "Error: invalid joint command interface " << it.name);
           temp_state.interface_name_vec.push_back(it.name);
-          temp_state.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+          temp_state.value_ptr_vec.push_back(nullptr);
         }
       }
       hdl_joint_states_.push_back(temp_state);
     }
+    AssignValueStorage(hdl_joint_states_, joint_state_values_);
 
     hdl_joint_commands_.clear();
     for (const hardware_interface::ComponentInfo& joint : info_.joints) {
@@ -206,10 +556,11 @@ namespace dynamixel_hardware_interface
           return hardware_interface::CallbackReturn::ERROR;
         }
         temp_cmd.interface_name_vec.push_back(it.name);
-        temp_cmd.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+        temp_cmd.value_ptr_vec.push_back(nullptr);
       }
       hdl_joint_commands_.push_back(temp_cmd);
     }
+    AssignValueStorage(hdl_joint_commands_, joint_command_values_);
 
     if (num_of_joints_ != hdl_joint_commands_.size() &&
       num_of_joints_ != hdl_joint_states_.size())
@@ -227,10 +578,14 @@ namespace dynamixel_hardware_interface
 
       for (auto it : sensor.state_interfaces) {
         temp_state.interface_name_vec.push_back(it.name);
-        temp_state.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+        temp_state.value_ptr_vec.push_back(nullptr);
       }
       hdl_sensor_states_.push_back(temp_state);
     }
+    AssignValueStorage(hdl_sensor_states_, sensor_state_values_);
+    SetConversionIndex();
+    SetErrorIndex();
+    SetSensorIndex();
 
     std::string str_dxl_state_pub_name =
       info_.hardware_parameters["dynamixel_state_pub_msg_name"];
@@ -279,6 +634,24 @@ namespace dynamixel_hardware_interface
 
     ros_update_freq_ = stoi(info_.hardware_parameters["ros_update_freq"]);
 
+    if (use_latency_stats_) {
+      std::string str_latency_stats_pub_name = "dynamixel_hardware_interface/latency_stats";
+      if (info_.hardware_parameters.find("latency_stats_pub_msg_name") !=
+        info_.hardware_parameters.end())
+      {
+        str_latency_stats_pub_name = info_.hardware_parameters.at("latency_stats_pub_msg_name");
+      }
+      latency_stats_pub_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+        str_latency_stats_pub_name, rclcpp::SystemDefaultsQoS());
+
+      // a cycle overruns when read() and write() together take longer than the update period
+      if (ros_update_freq_ > 0) {
+        latency_hist_[LATENCY_CYCLE].SetBudget(static_cast<uint64_t>(1e9 / ros_update_freq_));
+      }
+    }
+
+    StartExecutor();
+
     return hardware_interface::CallbackReturn::SUCCESS;
   }
 
@@ -291,21 +664,21 @@ namespace dynamixel_hardware_interface
       for (size_t i = 0; i < it.value_ptr_vec.size(); i++) {
         state_interfaces.emplace_back(
           hardware_interface::StateInterface(
-            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i).get()));
+            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i)));
       }
     }
     for (auto it : hdl_joint_states_) {
       for (size_t i = 0; i < it.value_ptr_vec.size(); i++) {
         state_interfaces.emplace_back(
           hardware_interface::StateInterface(
-            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i).get()));
+            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i)));
       }
     }
     for (auto it : hdl_sensor_states_) {
       for (size_t i = 0; i < it.value_ptr_vec.size(); i++) {
         state_interfaces.emplace_back(
           hardware_interface::StateInterface(
-            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i).get()));
+            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i)));
       }
     }
     return state_interfaces;
@@ -320,14 +693,14 @@ namespace dynamixel_hardware_interface
       for (size_t i = 0; i < it.value_ptr_vec.size(); i++) {
         command_interfaces.emplace_back(
           hardware_interface::CommandInterface(
-            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i).get()));
+            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i)));
       }
     }
     for (auto it : hdl_joint_commands_) {
       for (size_t i = 0; i < it.value_ptr_vec.size(); i++) {
         command_interfaces.emplace_back(
           hardware_interface::CommandInterface(
-            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i).get()));
+            it.name, it.interface_name_vec.at(i), it.value_ptr_vec.at(i)));
       }
     }
     return command_interfaces;
@@ -347,7 +720,22 @@ namespace dynamixel_hardware_interface
 
   hardware_interface::CallbackReturn DynamixelHardware::start()
   {
-    dxl_comm_err_ = CheckError(dxl_comm_->ReadMultiDxlData());
+    DxlError read_result = DxlError::OK;
+    for (auto& port : ports_) {
+      if (!port->has_read_items) {
+        continue;
+      }
+      DxlError result = port->dxl_comm->ReadMultiDxlData();
+      if (read_result == DxlError::OK) {
+        read_result = result;
+      }
+      if (use_io_thread_) {
+        // the I/O thread is not running yet, take its values directly
+        CopyHandlerValues(port->io_trans_states, port->trans_states);
+        CopyHandlerValues(port->io_gpio_sensor_states, port->gpio_sensor_states);
+      }
+    }
+    dxl_comm_err_ = CheckError(read_result);
     if (dxl_comm_err_ != DxlError::OK) {
       RCLCPP_ERROR_STREAM(
         logger_,
@@ -377,7 +765,12 @@ namespace dynamixel_hardware_interface
     }
     usleep(500 * 1000);
 
-    dxl_comm_->DynamixelEnable(dxl_id_);
+    for (auto& port : ports_) {
+      port->dxl_comm->DynamixelEnable(port->dxl_id);
+    }
+
+    StartPortThreads();
+    StartLatencyStats();
 
     RCLCPP_INFO_STREAM(logger_, "Dynamixel Hardware Start!");
 
@@ -386,7 +779,12 @@ namespace dynamixel_hardware_interface
 
   hardware_interface::CallbackReturn DynamixelHardware::stop()
   {
-    dxl_comm_->DynamixelDisable(dxl_id_);
+    StopLatencyStats();
+    StopPortThreads();
+
+    for (auto& port : ports_) {
+      port->dxl_comm->DynamixelDisable(port->dxl_id);
+    }
 
     RCLCPP_INFO_STREAM(logger_, "Dynamixel Hardware Stop!");
 
@@ -396,12 +794,19 @@ namespace dynamixel_hardware_interface
   hardware_interface::return_type DynamixelHardware::read(
     const rclcpp::Time& time, const rclcpp::Duration& period)
   {
+    auto read_start = std::chrono::steady_clock::now();
+    cycle_start_ = read_start;
+
+    if (comm_reset_running_) {
+      // CommReset() owns the bus on the executor thread, hold the last states
+      return hardware_interface::return_type::OK;
+    }
     if (dxl_status_ == REBOOTING) {
       RCLCPP_ERROR_STREAM(logger_, "Dynamixel Read Fail : REBOOTING");
       return hardware_interface::return_type::ERROR;
     }
     else if (dxl_status_ == DXL_OK || dxl_status_ == COMM_ERROR) {
-      dxl_comm_err_ = CheckError(dxl_comm_->ReadMultiDxlData());
+      dxl_comm_err_ = CheckError(ReadDxlStates());
       if (dxl_comm_err_ != DxlError::OK) {
         if (!is_read_in_error_) {
           is_read_in_error_ = true;
@@ -409,9 +814,9 @@ namespace dynamixel_hardware_interface
         }
         read_error_duration_ = read_error_duration_ + period;
 
-        RCLCPP_ERROR_STREAM(
-          logger_,
-          "Dynamixel Read Fail (Duration: " << read_error_duration_.seconds() * 1000 << "ms/" << err_timeout_ms_ << "ms)");
+        log_ring_.Log(
+          LOG_READ_FAIL, 0, static_cast<int64_t>(read_error_duration_.seconds() * 1000),
+          static_cast<int64_t>(err_timeout_ms_));
 
         if (read_error_duration_.seconds() * 1000 >= err_timeout_ms_) {
           return hardware_interface::return_type::ERROR;
@@ -422,51 +827,69 @@ namespace dynamixel_hardware_interface
       read_error_duration_ = rclcpp::Duration(0, 0);
     }
     else if (dxl_status_ == HW_ERROR) {
-      dxl_comm_err_ = CheckError(dxl_comm_->ReadMultiDxlData());
+      dxl_comm_err_ = CheckError(ReadDxlStates());
       if (dxl_comm_err_ != DxlError::OK) {
-        RCLCPP_ERROR_STREAM(
-          logger_,
-          "Dynamixel Read Fail :" << Dynamixel::DxlErrorToString(dxl_comm_err_));
+        log_ring_.Log(LOG_STATE_READ_FAIL, 0, dxl_comm_err_);
       }
     }
 
+    auto since = std::chrono::steady_clock::now();
     CalcTransmissionToJoint();
+    RecordLatency(LATENCY_CALC_TRANS_TO_JOINT, since);
 
-    for (auto sensor : hdl_gpio_sensor_states_) {
-      ReadSensorData(sensor);
+    // sensor items were read together with the states
+    for (size_t i = 0; i < sensor_src_value_.size(); i++) {
+      *sensor_dst_value_[i] = *sensor_src_value_[i];
     }
 
-    dxl_comm_->ReadItemBuf();
-
     size_t index = 0;
     if (dxl_state_pub_uni_ptr_ && dxl_state_pub_uni_ptr_->trylock()) {
       dxl_state_pub_uni_ptr_->msg_.header.stamp = this->now();
       dxl_state_pub_uni_ptr_->msg_.comm_state = dxl_comm_err_;
       for (auto it : hdl_trans_states_) {
         dxl_state_pub_uni_ptr_->msg_.id.at(index) = it.id;
-        dxl_state_pub_uni_ptr_->msg_.dxl_hw_state.at(index) = dxl_hw_err_[it.id];
+        dxl_state_pub_uni_ptr_->msg_.dxl_hw_state.at(index) = dxl_hw_err_[index];
         dxl_state_pub_uni_ptr_->msg_.torque_state.at(index) = dxl_torque_state_[it.id];
         index++;
       }
       dxl_state_pub_uni_ptr_->unlockAndPublish();
     }
-
-    if (rclcpp::ok()) {
-      rclcpp::spin_some(this->get_node_base_interface());
-    }
+    RecordLatency(LATENCY_STATE_PUBLISH, since);
+    RecordLatency(LATENCY_READ, read_start);
     return hardware_interface::return_type::OK;
   }
   hardware_interface::return_type DynamixelHardware::write(
     const rclcpp::Time& time, const rclcpp::Duration& period)
   {
-    if (dxl_status_ == DXL_OK || dxl_status_ == HW_ERROR) {
-      dxl_comm_->WriteItemBuf();
+    if (comm_reset_running_) {
+      return hardware_interface::return_type::OK;
+    }
+    auto write_start = std::chrono::steady_clock::now();
+    auto since = write_start;
+    ProcessServiceRequest();
+    RecordLatency(LATENCY_SERVICE_REQUEST, since);
+    if (comm_reset_running_) {
+      // the bus was just handed over to CommReset()
+      return hardware_interface::return_type::OK;
+    }
 
+    if (dxl_status_ == DXL_OK || dxl_status_ == HW_ERROR) {
       ChangeDxlTorqueState();
+      RecordLatency(LATENCY_TORQUE_CHANGE, since);
 
       CalcJointToTransmission();
+      RecordLatency(LATENCY_CALC_JOINT_TO_TRANS, since);
 
-      dxl_comm_->WriteMultiDxlData();
+      if (use_io_thread_) {
+        for (auto& port : ports_) {
+          PublishIoCommands(*port, true);
+        }
+      }
+      else {
+        RunPortJobs(PORT_JOB_WRITE);
+      }
+      RecordLatency(LATENCY_WRITE, write_start);
+      RecordLatency(LATENCY_CYCLE, cycle_start_);
 
       is_write_in_error_ = false;
       write_error_duration_ = rclcpp::Duration(0, 0);
@@ -474,11 +897,16 @@ namespace dynamixel_hardware_interface
       return hardware_interface::return_type::OK;
     }
     else {
+      if (use_io_thread_) {
+        for (auto& port : ports_) {
+          PublishIoCommands(*port, false);
+        }
+      }
       write_error_duration_ = write_error_duration_ + period;
 
-      RCLCPP_ERROR_STREAM(
-        logger_,
-        "Dynamixel Write Fail (Duration: " << write_error_duration_.seconds() * 1000 << "ms/" << err_timeout_ms_ << "ms)");
+      log_ring_.Log(
+        LOG_WRITE_FAIL, 0, static_cast<int64_t>(write_error_duration_.seconds() * 1000),
+        static_cast<int64_t>(err_timeout_ms_));
 
       if (write_error_duration_.seconds() * 1000 >= err_timeout_ms_) {
         return hardware_interface::return_type::ERROR;
@@ -494,145 +922,778 @@ namespace dynamixel_hardware_interface
 
     // check comm error
     if (dxl_comm_err != DxlError::OK) {
-      RCLCPP_ERROR_STREAM(
-        logger_,
-        "Communication Fail --> " << Dynamixel::DxlErrorToString(dxl_comm_err));
+      log_ring_.Log(LOG_COMM_FAIL, 0, dxl_comm_err);
       dxl_status_ = COMM_ERROR;
       return dxl_comm_err;
     }
-    // check hardware error
-    for (size_t i = 0; i < num_of_transmissions_; i++) {
-      for (size_t j = 0; j < hdl_trans_states_.at(i).interface_name_vec.size(); j++) {
-        if (hdl_trans_states_.at(i).interface_name_vec.at(j) == "Hardware Error Status") {
-          dxl_hw_err_[hdl_trans_states_.at(i).id] = *hdl_trans_states_.at(i).value_ptr_vec.at(j);
-          std::string error_string = "";
-          if (dxl_hw_err_[hdl_trans_states_.at(i).id] & 0x01) {
-            error_string += "input voltage error/ ";
-          }
-          if (dxl_hw_err_[hdl_trans_states_.at(i).id] & 0x04) {
-            error_string += "overheating/ ";
-          }
-          if (dxl_hw_err_[hdl_trans_states_.at(i).id] & 0x08) {
-            error_string += "motor encoder/ ";
-          }
-          if (dxl_hw_err_[hdl_trans_states_.at(i).id] & 0x16) {
-            error_string += "electrical shork/ ";
-          }
-          if (dxl_hw_err_[hdl_trans_states_.at(i).id] & 0x32) {
-            error_string += "Overload/ ";
-          }
-
-          if (!error_string.empty()) {
-            RCLCPP_WARN_STREAM(
-              logger_, "Dynamixel Hardware Error States [ ID:" <<
-              static_cast<int>(hdl_trans_states_.at(i).id) << "] --> " <<
-              static_cast<int>(dxl_hw_err_[hdl_trans_states_.at(i).id]) <<
-              "/ " << error_string);
-            dxl_status_ = HW_ERROR;
-            error_state = DxlError::DLX_HARDWARE_ERROR;
-          }
-        }
+    // check hardware error, only a change of the error bits is logged
+    uint8_t hw_err = 0;
+    for (size_t k = 0; k < hw_err_value_.size(); k++) {
+      const size_t i = hw_err_trans_index_[k];
+      const uint8_t err = static_cast<uint8_t>(*hw_err_value_[k]);
+      if ((err ^ dxl_hw_err_[i]) & HW_ERROR_MASK) {
+        log_ring_.Log(LOG_HW_ERROR, hdl_trans_states_[i].id, err);
       }
+      dxl_hw_err_[i] = err;
+      hw_err |= err;
+    }
+    if (hw_err & HW_ERROR_MASK) {
+      dxl_status_ = HW_ERROR;
+      error_state = DxlError::DLX_HARDWARE_ERROR;
     }
 
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      for (size_t j = 0; j < hdl_joint_states_.at(i).interface_name_vec.size(); j++) {
-        if (hdl_joint_states_.at(i).interface_name_vec.at(j) == HW_IF_HARDWARE_STATE) {
-          *hdl_joint_states_.at(i).value_ptr_vec.at(j) = error_state;
-        }
-      }
+    for (auto value : hw_state_value_) {
+      *value = error_state;
     }
 
     return error_state;
   }
 
-  bool DynamixelHardware::CommReset()
+  void DynamixelHardware::StartPortThreads()
   {
-    dxl_status_ = REBOOTING;
-    stop();
-    RCLCPP_INFO_STREAM(logger_, "Communication Reset Start");
-    dxl_comm_->RWDataReset();
+    // a single port without I/O thread keeps running inline in read() / write()
+    if (port_threads_running_ || (!use_io_thread_ && ports_.size() < 2)) {
+      return;
+    }
 
-    auto start_time = this->now();
-    while ((this->now() - start_time) < rclcpp::Duration(3, 0)) {
-      usleep(200 * 1000);
-      RCLCPP_INFO_STREAM(logger_, "Reset Start");
-      bool result = true;
-      for (auto id : dxl_id_) {
-        if (dxl_comm_->Reboot(id) != DxlError::OK) {
-          RCLCPP_ERROR_STREAM(logger_, "Cannot reboot dynamixel! :(");
-          result = false;
-          break;
+    if (use_io_thread_) {
+      std::chrono::nanoseconds cycle(0);
+      if (io_thread_rate_hz_ > 0.0) {
+        cycle = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / io_thread_rate_hz_));
+      }
+      io_state_timeout_ = std::min(
+        std::max<std::chrono::nanoseconds>(cycle * IO_STATE_STALE_CYCLES, IO_STATE_STALE_MIN),
+        std::chrono::nanoseconds(static_cast<int64_t>(err_timeout_ms_ * 1e6)));
+    }
+
+    for (auto& port : ports_) {
+      if (use_io_thread_) {
+        // states + comm error + torque change result + torque state of every Dynamixel
+        port->state_buf.Init(
+          CountValues(port->io_trans_states) + CountValues(port->io_gpio_sensor_states) + 3 +
+          port->dxl_id.size());
+        // commands + write enable + torque change
+        port->command_buf.Init(CountValues(port->io_trans_commands) + 4);
+        port->comm_err = DxlError::OK;
+        port->state_stamp = std::chrono::steady_clock::now();
+        // a change posted while no thread ran is dropped
+        port->torque_done_seq = port->torque_seq;
+        port->io_running.store(true);
+        port->thread = std::thread(&DynamixelHardware::IoThreadLoop, this, std::ref(*port));
+      }
+      else {
+        port->job = PORT_JOB_NONE;
+        port->thread = std::thread(&DynamixelHardware::PortThreadLoop, this, std::ref(*port));
+      }
+
+      if (port->cpu >= 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(port->cpu, &cpu_set);
+        if (pthread_setaffinity_np(port->thread.native_handle(), sizeof(cpu_set_t), &cpu_set) != 0) {
+          RCLCPP_WARN_STREAM(
+            logger_, "Cannot pin the " << port->port_name << " thread to CPU " << port->cpu);
         }
-        usleep(200 * 1000);
       }
-      if (!result) { continue; }
-      if (!InitDxlItems()) { continue; }
-      if (!InitDxlReadItems()) { continue; }
-      if (!InitDxlWriteItems()) { continue; }
+    }
+    port_threads_running_ = true;
+    RCLCPP_INFO_STREAM(logger_, "Port threads started (" << ports_.size() << ")");
+  }
 
-      RCLCPP_INFO_STREAM(logger_, "RESET Success");
-      usleep(1000 * 1000);
-      start();
-      dxl_status_ = DXL_OK;
-      return true;
+  void DynamixelHardware::StopPortThreads()
+  {
+    if (!port_threads_running_) {
+      return;
     }
-    RCLCPP_ERROR_STREAM(logger_, "RESET Failure");
-    usleep(1000 * 1000);
-    start();
-    return false;
+
+    for (auto& port : ports_) {
+      if (use_io_thread_) {
+        port->io_running.store(false);
+      }
+      else {
+        std::lock_guard<std::mutex> job_lock(port->job_mutex);
+        port->job = PORT_JOB_EXIT;
+        port->job_cv.notify_all();
+      }
+    }
+    for (auto& port : ports_) {
+      if (port->thread.joinable()) {
+        port->thread.join();
+      }
+    }
+    port_threads_running_ = false;
+    RCLCPP_INFO_STREAM(logger_, "Port threads stopped");
   }
 
-  bool DynamixelHardware::InitDxlItems()
+  void DynamixelHardware::PortThreadLoop(DxlPortType& port)
   {
-    RCLCPP_INFO_STREAM(logger_, "$$$$$ Init Dxl Items");
-    for (const hardware_interface::ComponentInfo& gpio : info_.gpios) {
-      uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
-      // First write items containing "Limit"
-      for (auto it : gpio.parameters) {
-        if (it.first != "ID" && it.first != "type" && it.first.find("Limit") != std::string::npos) {
-          if (dxl_comm_->WriteItem(
-            id, it.first,
-            static_cast<uint32_t>(stoi(it.second))) != DxlError::OK)
-          {
-            RCLCPP_ERROR_STREAM(logger_, "[ID:" << std::to_string(id) << "] Write Item error");
-            return false;
-          }
-          RCLCPP_INFO_STREAM(
-            logger_,
-            "[ID:" << std::to_string(id) << "] item_name:" << it.first.c_str() << "\tdata:" <<
-            stoi(it.second));
-        }
+    std::unique_lock<std::mutex> job_lock(port.job_mutex);
+    while (true) {
+      port.job_cv.wait(job_lock, [&port] {return port.job != PORT_JOB_NONE;});
+      if (port.job == PORT_JOB_EXIT) {
+        port.job = PORT_JOB_NONE;
+        return;
       }
 
-      // Then write the remaining items
-      for (auto it : gpio.parameters) {
-        if (it.first != "ID" && it.first != "type" && it.first.find("Limit") == std::string::npos) {
-          if (dxl_comm_->WriteItem(
-            id, it.first,
-            static_cast<uint32_t>(stoi(it.second))) != DxlError::OK)
-          {
-            RCLCPP_ERROR_STREAM(logger_, "[ID:" << std::to_string(id) << "] Write Item error");
-            return false;
-          }
-          RCLCPP_INFO_STREAM(
-            logger_,
-            "[ID:" << std::to_string(id) << "] item_name:" << it.first.c_str() << "\tdata:" <<
-            stoi(it.second));
+      PortJob job = port.job;
+      job_lock.unlock();
+      {
+        std::lock_guard<std::mutex> lock(port.mutex);
+        DxlError result = RunPortJob(port, job);
+        if (job == PORT_JOB_READ) {
+          port.comm_err = result;
         }
       }
+      job_lock.lock();
+      port.job = PORT_JOB_NONE;
+      port.job_cv.notify_all();
     }
-    return true;
   }
 
-  bool DynamixelHardware::InitDxlReadItems()
+  void DynamixelHardware::IoThreadLoop(DxlPortType& port)
   {
-    RCLCPP_INFO_STREAM(logger_, "$$$$$ Init Dxl Read Items");
-    static bool is_set_hdl = false;
-
-    if (!is_set_hdl) {
-      hdl_trans_states_.clear();
-      hdl_gpio_sensor_states_.clear();
+    std::chrono::nanoseconds cycle(0);
+    if (io_thread_rate_hz_ > 0.0) {
+      cycle = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / io_thread_rate_hz_));
+    }
+    auto next_cycle = std::chrono::steady_clock::now();
+    // nothing is written before write() has handed over its first command
+    bool write_enable = false;
+    // torque changes come with the commands, so the bus is never contended for them
+    uint32_t torque_done_seq = port.torque_done_seq;
+    bool torque_result = false;
+
+    while (port.io_running.load()) {
+      {
+        std::lock_guard<std::mutex> lock(port.mutex);
+
+        if (port.command_buf.Fetch()) {
+          const std::vector<double>& command = port.command_buf.Front();
+          size_t index = CopyFromSnapshot(command, 0, port.io_trans_commands);
+          write_enable = command[index] != 0.0;
+          uint32_t torque_seq = static_cast<uint32_t>(command[index + 1]);
+          if (torque_seq != torque_done_seq) {
+            // before the write, the commands of this snapshot were synced for the change
+            torque_result = ChangePortTorque(
+              port, command[index + 2] != 0.0, static_cast<int>(command[index + 3]));
+            torque_done_seq = torque_seq;
+          }
+        }
+        if (write_enable) {
+          RunPortJob(port, PORT_JOB_WRITE);
+        }
+        DxlError comm_err = RunPortJob(port, PORT_JOB_READ);
+
+        std::vector<double>& state = port.state_buf.Back();
+        size_t index = CopyToSnapshot(port.io_trans_states, state, 0);
+        index = CopyToSnapshot(port.io_gpio_sensor_states, state, index);
+        state[index++] = static_cast<double>(comm_err);
+        state[index++] = static_cast<double>(torque_done_seq);
+        state[index++] = torque_result ? 1.0 : 0.0;
+        const std::map<uint8_t, bool>& torque_state = port.dxl_comm->GetDxlTorqueState();
+        for (auto id : port.dxl_id) {
+          auto it = torque_state.find(id);
+          state[index++] = (it != torque_state.end() && it->second) ? 1.0 : 0.0;
+        }
+        port.state_buf.Publish();
+      }
+
+      if (cycle.count() > 0) {
+        next_cycle += cycle;
+        std::this_thread::sleep_until(next_cycle);
+      }
+      else {
+        // let service callbacks get the bus between cycles
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  DxlError DynamixelHardware::RunPortJob(DxlPortType& port, PortJob job)
+  {
+    DxlError result = DxlError::OK;
+    if (job == PORT_JOB_READ) {
+      if (port.has_read_items) {
+        result = port.dxl_comm->ReadMultiDxlData();
+        if (use_latency_stats_) {
+          latency_hist_[LATENCY_READ_TXRX].Record(port.dxl_comm->GetReadTxRxTime());
+          if (result == DxlError::OK) {
+            latency_hist_[LATENCY_READ_DECODE].Record(port.dxl_comm->GetReadDecodeTime());
+          }
+        }
+      }
+      auto since = std::chrono::steady_clock::now();
+      port.dxl_comm->ReadItemBuf();
+      RecordLatency(LATENCY_READ_ITEM_BUF, since);
+    }
+    else if (job == PORT_JOB_WRITE) {
+      auto since = std::chrono::steady_clock::now();
+      port.dxl_comm->WriteItemBuf();
+      if (!port.trans_commands.empty()) {
+        port.dxl_comm->WriteMultiDxlData();
+
+        if (use_pipelined_read_ && !use_io_thread_ && port.has_read_items) {
+          // send the next read request now, the next read() only collects the response
+          port.dxl_comm->RequestMultiDxlData();
+        }
+      }
+      RecordLatency(LATENCY_BUS_WRITE, since);
+    }
+    else if (job == PORT_JOB_TORQUE) {
+      if (port.torque_done_seq != port.torque_seq) {
+        port.torque_result = ChangePortTorque(port, port.torque_enable, port.torque_id);
+        port.torque_done_seq = port.torque_seq;
+      }
+    }
+    return result;
+  }
+
+  void DynamixelHardware::RunPortJobs(PortJob job)
+  {
+    if (!port_threads_running_) {
+      for (auto& port : ports_) {
+        std::lock_guard<std::mutex> lock(port->mutex);
+        DxlError result = RunPortJob(*port, job);
+        if (job == PORT_JOB_READ) {
+          port->comm_err = result;
+        }
+      }
+      return;
+    }
+
+    for (auto& port : ports_) {
+      std::lock_guard<std::mutex> job_lock(port->job_mutex);
+      port->job = job;
+      port->job_cv.notify_all();
+    }
+    // barrier: every port has finished before the states are used
+    for (auto& port : ports_) {
+      std::unique_lock<std::mutex> job_lock(port->job_mutex);
+      port->job_cv.wait(job_lock, [&port] {return port->job == PORT_JOB_NONE;});
+    }
+  }
+
+  DxlError DynamixelHardware::ReadDxlStates()
+  {
+    if (use_io_thread_) {
+      auto now = std::chrono::steady_clock::now();
+      for (auto& port : ports_) {
+        if (port->state_buf.Fetch()) {
+          port->state_stamp = now;
+          const std::vector<double>& state = port->state_buf.Front();
+          size_t index = CopyFromSnapshot(state, 0, port->trans_states);
+          index = CopyFromSnapshot(state, index, port->gpio_sensor_states);
+          port->comm_err = static_cast<DxlError>(static_cast<int>(state[index++]));
+          port->torque_done_seq = static_cast<uint32_t>(state[index++]);
+          port->torque_result = state[index++] != 0.0;
+          for (auto id : port->dxl_id) {
+            dxl_torque_state_[id] = state[index++] != 0.0;
+          }
+        }
+        else if (now - port->state_stamp > io_state_timeout_ && port->comm_err == DxlError::OK) {
+          // the I/O thread hangs in a bus transfer, the held states are getting old
+          port->comm_err = DxlError::SYNC_READ_FAIL;
+        }
+      }
+    }
+    else {
+      RunPortJobs(PORT_JOB_READ);
+    }
+
+    for (auto& port : ports_) {
+      if (port->comm_err != DxlError::OK) {
+        return port->comm_err;
+      }
+    }
+    return DxlError::OK;
+  }
+
+  void DynamixelHardware::PublishIoCommands(DxlPortType& port, bool write_enable)
+  {
+    std::vector<double>& command = port.command_buf.Back();
+    size_t index = CopyToSnapshot(port.trans_commands, command, 0);
+    command[index] = write_enable ? 1.0 : 0.0;
+    // repeated in every snapshot until the I/O thread reports it done, none is lost
+    command[index + 1] = static_cast<double>(port.torque_seq);
+    command[index + 2] = port.torque_enable ? 1.0 : 0.0;
+    command[index + 3] = static_cast<double>(port.torque_id);
+    port.command_buf.Publish();
+  }
+
+  void DynamixelHardware::PostTorqueChange(DxlPortType& port, bool enable, int id)
+  {
+    port.torque_enable = enable;
+    port.torque_id = id;
+    port.torque_seq++;
+  }
+
+  bool DynamixelHardware::ChangePortTorque(DxlPortType& port, bool enable, int id)
+  {
+    std::vector<uint8_t> id_arr;
+    if (id < 0) {
+      id_arr = port.dxl_id;
+    }
+    else {
+      id_arr.push_back(static_cast<uint8_t>(id));
+    }
+    if (enable) {
+      return port.dxl_comm->DynamixelEnable(id_arr) == DxlError::OK;
+    }
+    return port.dxl_comm->DynamixelDisable(id_arr) == DxlError::OK;
+  }
+
+  void DynamixelHardware::RecordLatency(
+    LatencyPhase phase, std::chrono::steady_clock::time_point& since)
+  {
+    if (!use_latency_stats_) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    latency_hist_[phase].Record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - since).count());
+    since = now;
+  }
+
+  void DynamixelHardware::StartLatencyStats()
+  {
+    if (!use_latency_stats_ || latency_stats_thread_.joinable()) {
+      return;
+    }
+    latency_stats_running_ = true;
+    latency_stats_thread_ = std::thread(&DynamixelHardware::LatencyStatsLoop, this);
+  }
+
+  void DynamixelHardware::StopLatencyStats()
+  {
+    if (!latency_stats_thread_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(latency_stats_mutex_);
+      latency_stats_running_ = false;
+      latency_stats_cv_.notify_all();
+    }
+    latency_stats_thread_.join();
+  }
+
+  void DynamixelHardware::LatencyStatsLoop()
+  {
+    std::unique_lock<std::mutex> lock(latency_stats_mutex_);
+    while (true) {
+      latency_stats_cv_.wait_for(
+        lock, latency_stats_period_, [this] {return !latency_stats_running_;});
+      if (!latency_stats_running_) {
+        return;
+      }
+
+      diagnostic_msgs::msg::DiagnosticArray msg;
+      msg.header.stamp = this->now();
+      for (size_t i = 0; i < LATENCY_PHASE_COUNT; i++) {
+        LatencyStats stats;
+        latency_hist_[i].TakeStats(stats);
+        if (stats.count == 0) {
+          continue;
+        }
+
+        diagnostic_msgs::msg::DiagnosticStatus status;
+        status.name = std::string("dynamixel_hardware_interface: ") + LATENCY_PHASE_NAME[i];
+        status.hardware_id = "dynamixel_hardware_interface";
+        status.level = stats.overruns > 0 ?
+          diagnostic_msgs::msg::DiagnosticStatus::WARN : diagnostic_msgs::msg::DiagnosticStatus::OK;
+        status.message = stats.overruns > 0 ? "overrun" : "ok";
+
+        diagnostic_msgs::msg::KeyValue value;
+        value.key = "count";
+        value.value = std::to_string(stats.count);
+        status.values.push_back(value);
+        value.key = "p50_ns";
+        value.value = std::to_string(stats.p50_ns);
+        status.values.push_back(value);
+        value.key = "p99_ns";
+        value.value = std::to_string(stats.p99_ns);
+        status.values.push_back(value);
+        value.key = "max_ns";
+        value.value = std::to_string(stats.max_ns);
+        status.values.push_back(value);
+        value.key = "overruns";
+        value.value = std::to_string(stats.overruns);
+        status.values.push_back(value);
+        msg.status.push_back(status);
+      }
+      latency_stats_pub_->publish(msg);
+    }
+  }
+
+  void DynamixelHardware::StartLogThread()
+  {
+    if (log_thread_.joinable()) {
+      return;
+    }
+    log_running_ = true;
+    log_thread_ = std::thread(&DynamixelHardware::LogThreadLoop, this);
+  }
+
+  void DynamixelHardware::StopLogThread()
+  {
+    if (!log_thread_.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(log_mutex_);
+      log_running_ = false;
+      log_cv_.notify_all();
+    }
+    log_thread_.join();
+    DrainLogRing();
+  }
+
+  void DynamixelHardware::LogThreadLoop()
+  {
+    std::unique_lock<std::mutex> lock(log_mutex_);
+    while (true) {
+      log_cv_.wait_for(lock, LOG_DRAIN_PERIOD, [this] {return !log_running_;});
+      if (!log_running_) {
+        return;
+      }
+      DrainLogRing();
+    }
+  }
+
+  void DynamixelHardware::DrainLogRing()
+  {
+    dynamixel::PacketHandler* packet_handler = dynamixel::PacketHandler::getPacketHandler();
+    LogEvent event;
+    while (log_ring_.Pop(event)) {
+      std::stringstream ss;
+      switch (event.code) {
+        case LOG_READ_REQUEST_FAIL:
+          ss << "Read Request Tx Fail [Error code : " << event.value << "]";
+          break;
+        case LOG_SYNC_READ_FAIL:
+          ss << (event.aux ? "Fast" : "") << "SyncRead TxRx Fail [Error code : " <<
+            event.value << "]";
+          break;
+        case LOG_BULK_READ_FAIL:
+          ss << (event.aux ? "Fast" : "") << "BulkRead TxRx Fail [Error code : " <<
+            event.value << "]";
+          break;
+        case LOG_SYNC_WRITE_FAIL:
+        case LOG_BULK_WRITE_FAIL:
+          ss << (event.code == LOG_SYNC_WRITE_FAIL ? "SyncWrite" : "BulkWrite") << " Fail : " <<
+            packet_handler->getTxRxResult(static_cast<int>(event.value));
+          break;
+        case LOG_ITEM_READ_COMM_FAIL:
+          ss << "[ID:" << static_cast<int>(event.id) << "] COMM_ERROR : " <<
+            packet_handler->getTxRxResult(static_cast<int>(event.value));
+          break;
+        case LOG_ITEM_READ_PACKET_ERROR:
+          ss << "[ID:" << static_cast<int>(event.id) << "] RX_PACKET_ERROR : " <<
+            packet_handler->getRxPacketError(static_cast<uint8_t>(event.value));
+          break;
+        case LOG_COMM_FAIL:
+          ss << "Communication Fail --> " <<
+            Dynamixel::DxlErrorToString(static_cast<DxlError>(event.value));
+          break;
+        case LOG_HW_ERROR:
+          ss << "Dynamixel Hardware Error States [ ID:" << static_cast<int>(event.id) << "] --> " <<
+            event.value << "/ " << HardwareErrorToString(static_cast<uint8_t>(event.value));
+          break;
+        case LOG_READ_FAIL:
+          ss << "Dynamixel Read Fail (Duration: " << event.value << "ms/" << event.aux << "ms)";
+          break;
+        case LOG_STATE_READ_FAIL:
+          ss << "Dynamixel Read Fail :" <<
+            Dynamixel::DxlErrorToString(static_cast<DxlError>(event.value));
+          break;
+        case LOG_WRITE_FAIL:
+          ss << "Dynamixel Write Fail (Duration: " << event.value << "ms/" << event.aux << "ms)";
+          break;
+        case LOG_SENSOR_READ_FAIL:
+          ss << "Sensor BulkRead TxRx Fail [Error code : " << event.value <<
+            "], keeping the last sensor values";
+          break;
+        default:
+          ss << "Unknown log event " << static_cast<int>(event.code);
+          break;
+      }
+      if (event.suppressed > 0) {
+        ss << " (" << event.suppressed << " more suppressed)";
+      }
+
+      if (event.code == LOG_HW_ERROR) {
+        RCLCPP_WARN_STREAM(logger_, ss.str());
+      }
+      else {
+        RCLCPP_ERROR_STREAM(logger_, ss.str());
+      }
+    }
+
+    uint64_t dropped = log_ring_.TakeDropped();
+    if (dropped > 0) {
+      RCLCPP_WARN_STREAM(logger_, "Log ring full, " << dropped << " events dropped");
+    }
+  }
+
+  void DynamixelHardware::StartExecutor()
+  {
+    if (executor_thread_.joinable()) {
+      return;
+    }
+    executor_ = std::make_unique<rclcpp::executors::SingleThreadedExecutor>();
+    executor_->add_node(this->get_node_base_interface());
+    executor_running_ = true;
+    executor_thread_ = std::thread(
+      [this]()
+      {
+        while (executor_running_ && rclcpp::ok()) {
+          executor_->spin_once(std::chrono::milliseconds(100));
+        }
+      });
+  }
+
+  void DynamixelHardware::StopExecutor()
+  {
+    if (!executor_thread_.joinable()) {
+      return;
+    }
+    executor_running_ = false;
+    executor_->cancel();
+    executor_thread_.join();
+    executor_->remove_node(this->get_node_base_interface());
+    executor_.reset();
+  }
+
+  bool DynamixelHardware::CallControlLoop(
+    ServiceRequestType type, uint8_t id, bool enable, std::chrono::milliseconds timeout)
+  {
+    ServiceRequest request;
+    request.seq = ++service_seq_;
+    request.type = type;
+    request.id = id;
+    request.enable = enable;
+    service_claim_seq_ = request.seq;
+    if (!service_request_queue_.Push(request)) {
+      service_claim_seq_ = 0;
+      RCLCPP_ERROR_STREAM(logger_, "Service request queue is full");
+      return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    bool started = false;
+    while (true) {
+      ServiceResponse response;
+      while (service_response_queue_.Pop(response)) {
+        // older sequence numbers answer requests whose caller already timed out
+        if (response.seq == request.seq) {
+          return response.result;
+        }
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        if (started) {
+          break;
+        }
+        // withdraw the request so a late control loop never carries it out
+        uint32_t expected = request.seq;
+        if (service_claim_seq_.compare_exchange_strong(expected, 0)) {
+          break;
+        }
+        // the control loop already started it and answers within its own deadline
+        started = true;
+        deadline = std::chrono::steady_clock::now() + timeout;
+        continue;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    RCLCPP_ERROR_STREAM(logger_, "Service request timeout, is the control loop running?");
+    return false;
+  }
+
+  void DynamixelHardware::ProcessServiceRequest()
+  {
+    if (!has_pending_request_) {
+      if (!service_request_queue_.Pop(pending_request_)) {
+        return;
+      }
+      uint32_t expected = pending_request_.seq;
+      if (!service_claim_seq_.compare_exchange_strong(expected, 0)) {
+        // the caller already timed out and withdrew it
+        return;
+      }
+      has_pending_request_ = true;
+      pending_request_deadline_ = std::chrono::steady_clock::now() + SERVICE_REQUEST_DEADLINE;
+      if (pending_request_.type == REQUEST_TORQUE) {
+        // carried out by ChangeDxlTorqueState() in write()
+        dxl_torque_status_ = pending_request_.enable ? REQUESTED_TO_ENABLE : REQUESTED_TO_DISABLE;
+        return;
+      }
+    }
+
+    bool wait = std::chrono::steady_clock::now() < pending_request_deadline_;
+    ServiceResponse response;
+    response.seq = pending_request_.seq;
+    response.result = false;
+    switch (pending_request_.type) {
+      case REQUEST_TORQUE:
+        if (dxl_torque_status_ == REQUESTED_TO_ENABLE ||
+          dxl_torque_status_ == REQUESTED_TO_DISABLE)
+        {
+          if ((dxl_status_ == DXL_OK || dxl_status_ == HW_ERROR) && wait) {
+            return;
+          }
+          // no torque change while the bus is in error. past the deadline, a change already
+          // posted to the ports still finishes in ChangeDxlTorqueState()
+          break;
+        }
+        response.result = (dxl_torque_status_ == TORQUE_ENABLED) == pending_request_.enable;
+        break;
+
+      case REQUEST_TORQUE_ID:
+      {
+        DxlPortType* port = GetPort(pending_request_.id);
+        if (port == nullptr) {
+          break;
+        }
+        if (!torque_id_posted_) {
+          if (torque_change_running_) {
+            // a change of every Dynamixel is still on the bus
+            if (wait) {
+              return;
+            }
+            break;
+          }
+          // the port's own thread writes it, the control loop never takes the bus lock
+          PostTorqueChange(*port, pending_request_.enable, pending_request_.id);
+          torque_id_posted_ = true;
+          if (!use_io_thread_) {
+            RunPortJobs(PORT_JOB_TORQUE);
+          }
+        }
+        if (port->torque_done_seq != port->torque_seq) {
+          // the I/O thread reports it with a later state snapshot
+          if (wait) {
+            return;
+          }
+          torque_id_posted_ = false;
+          break;
+        }
+        torque_id_posted_ = false;
+        response.result = port->torque_result;
+        break;
+      }
+
+      case REQUEST_REBOOT:
+        // read() and write() stay off the bus until CommReset() clears the flag
+        comm_reset_running_ = true;
+        response.result = true;
+        break;
+    }
+
+    has_pending_request_ = false;
+    service_response_queue_.Push(response);
+  }
+
+  DxlPortType* DynamixelHardware::GetPort(uint8_t id)
+  {
+    auto it = id_to_port_.find(id);
+    if (it == id_to_port_.end()) {
+      return nullptr;
+    }
+    return ports_.at(it->second).get();
+  }
+
+  bool DynamixelHardware::CommReset()
+  {
+    dxl_status_ = REBOOTING;
+    stop();
+    RCLCPP_INFO_STREAM(logger_, "Communication Reset Start");
+    for (auto& port : ports_) {
+      port->dxl_comm->RWDataReset();
+    }
+
+    auto start_time = this->now();
+    while ((this->now() - start_time) < rclcpp::Duration(3, 0)) {
+      usleep(200 * 1000);
+      RCLCPP_INFO_STREAM(logger_, "Reset Start");
+      bool result = true;
+      for (auto& port : ports_) {
+        for (auto id : port->dxl_id) {
+          if (port->dxl_comm->Reboot(id) != DxlError::OK) {
+            RCLCPP_ERROR_STREAM(logger_, "Cannot reboot dynamixel! :(");
+            result = false;
+            break;
+          }
+          usleep(200 * 1000);
+        }
+        if (!result) { break; }
+      }
+      if (!result) { continue; }
+      if (!InitDxlItems()) { continue; }
+      if (!InitDxlReadItems()) { continue; }
+      if (!InitDxlWriteItems()) { continue; }
+
+      RCLCPP_INFO_STREAM(logger_, "RESET Success");
+      usleep(1000 * 1000);
+      start();
+      dxl_status_ = DXL_OK;
+      return true;
+    }
+    RCLCPP_ERROR_STREAM(logger_, "RESET Failure");
+    usleep(1000 * 1000);
+    start();
+    return false;
+  }
+
+  bool DynamixelHardware::InitDxlItems()
+  {
+    RCLCPP_INFO_STREAM(logger_, "$$$$$ Init Dxl Items");
+    // First items containing "Limit", then the remaining items.
+    // Every port reads its servos back and writes only the items that differ.
+    for (bool limit_items : {true, false}) {
+      std::vector<std::vector<RWItemBufInfo>> port_items(ports_.size());
+      for (const hardware_interface::ComponentInfo& gpio : info_.gpios) {
+        uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
+        size_t port_idx = id_to_port_.at(id);
+        for (auto it : gpio.parameters) {
+          if (it.first == "ID" || it.first == "type" || it.first == "port" ||
+            it.first == "read_divisor" ||
+            (it.first.find("Limit") != std::string::npos) != limit_items)
+          {
+            continue;
+          }
+          RWItemBufInfo item;
+          item.id = id;
+          item.control_item.item_name = it.first;
+          item.data = static_cast<uint32_t>(stoi(it.second));
+          item.read_flag = false;
+          port_items.at(port_idx).push_back(item);
+          RCLCPP_INFO_STREAM(
+            logger_,
+            "[ID:" << std::to_string(id) << "] item_name:" << it.first.c_str() << "\tdata:" <<
+            stoi(it.second));
+        }
+      }
+
+      for (size_t i = 0; i < ports_.size(); i++) {
+        if (port_items.at(i).empty()) {
+          continue;
+        }
+        if (ports_.at(i)->dxl_comm->SyncConfigItems(port_items.at(i)) != DxlError::OK) {
+          RCLCPP_ERROR_STREAM(logger_, "[" << ports_.at(i)->port_name << "] Write Item error");
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool DynamixelHardware::InitDxlReadItems()
+  {
+    RCLCPP_INFO_STREAM(logger_, "$$$$$ Init Dxl Read Items");
+    static bool is_set_hdl = false;
+
+    if (!is_set_hdl) {
+      hdl_trans_states_.clear();
+      hdl_gpio_sensor_states_.clear();
       for (const hardware_interface::ComponentInfo& gpio : info_.gpios) {
         if (gpio.state_interfaces.size() && gpio.parameters.at("type") == "dxl") {
           uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
@@ -643,17 +1704,17 @@ namespace dynamixel_hardware_interface
 
           // Present Position
           temp_read.interface_name_vec.push_back("Present Position");
-          temp_read.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+          temp_read.value_ptr_vec.push_back(nullptr);
 
           // Present Velocity
           temp_read.interface_name_vec.push_back("Present Velocity");
-          temp_read.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+          temp_read.value_ptr_vec.push_back(nullptr);
 
           // effort third
           for (auto it : gpio.state_interfaces) {
             if (it.name == "Present Current" || it.name == "Present Load") {
               temp_read.interface_name_vec.push_back(it.name);
-              temp_read.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+              temp_read.value_ptr_vec.push_back(nullptr);
             }
           }
 
@@ -662,11 +1723,7 @@ namespace dynamixel_hardware_interface
               it.name != "Present Current" && it.name != "Present Load")
             {
               temp_read.interface_name_vec.push_back(it.name);
-              temp_read.value_ptr_vec.push_back(std::make_shared<double>(0.0));
-
-              if (it.name == "Hardware Error Status") {
-                dxl_hw_err_[id] = 0x00;
-              }
+              temp_read.value_ptr_vec.push_back(nullptr);
             }
           }
           hdl_trans_states_.push_back(temp_read);
@@ -674,32 +1731,77 @@ namespace dynamixel_hardware_interface
         }
         else if (gpio.state_interfaces.size() && gpio.parameters.at("type") == "sensor") {
           HandlerVarType temp_sensor;
-          for (auto it : gpio.state_interfaces) {
-            uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
+          uint8_t id = static_cast<uint8_t>(stoi(gpio.parameters.at("ID")));
 
-            temp_sensor.id = id;
-            temp_sensor.name = gpio.name;
-            for (auto it : gpio.state_interfaces) {
-              temp_sensor.interface_name_vec.push_back(it.name);
-              temp_sensor.value_ptr_vec.push_back(std::make_shared<double>(0.0));
-            }
+          temp_sensor.id = id;
+          temp_sensor.name = gpio.name;
+          for (auto it : gpio.state_interfaces) {
+            temp_sensor.interface_name_vec.push_back(it.name);
+            temp_sensor.value_ptr_vec.push_back(nullptr);
           }
           hdl_gpio_sensor_states_.push_back(temp_sensor);
         }
       }
+
+      AssignValueStorage(hdl_trans_states_, trans_state_values_);
+      AssignValueStorage(hdl_gpio_sensor_states_, gpio_sensor_state_values_);
+
+      // the port handlers share their values with the hdl handlers
+      for (auto& port : ports_) {
+        port->trans_states.clear();
+        port->gpio_sensor_states.clear();
+      }
+      for (const auto& it : hdl_trans_states_) {
+        GetPort(it.id)->trans_states.push_back(it);
+      }
+      for (const auto& it : hdl_gpio_sensor_states_) {
+        GetPort(it.id)->gpio_sensor_states.push_back(it);
+      }
+      for (auto& port : ports_) {
+        port->io_trans_states = CloneHandler(port->trans_states, port->io_trans_state_values);
+        port->io_gpio_sensor_states =
+          CloneHandler(port->gpio_sensor_states, port->io_gpio_sensor_state_values);
+      }
       is_set_hdl = true;
     }
-    for (auto it : hdl_trans_states_) {
-      if (dxl_comm_->SetDxlReadItems(
-        it.id, it.interface_name_vec,
-        it.value_ptr_vec) != DxlError::OK)
-      {
+
+    for (auto& port : ports_) {
+      port->has_read_items = !port->trans_states.empty() || !port->gpio_sensor_states.empty();
+      if (!port->has_read_items) {
+        continue;
+      }
+      // with the I/O thread, dxl_comm decodes into values only that thread touches
+      for (auto it : use_io_thread_ ? port->io_trans_states : port->trans_states) {
+        // position, velocity and effort lead the handler and are read every cycle
+        size_t fast_item_cnt = 0;
+        while (fast_item_cnt < it.interface_name_vec.size() &&
+          (it.interface_name_vec.at(fast_item_cnt) == "Present Position" ||
+          it.interface_name_vec.at(fast_item_cnt) == "Present Velocity" ||
+          it.interface_name_vec.at(fast_item_cnt) == "Present Current" ||
+          it.interface_name_vec.at(fast_item_cnt) == "Present Load"))
+        {
+          fast_item_cnt++;
+        }
+        if (port->dxl_comm->SetDxlReadItems(
+          it.id, it.interface_name_vec,
+          it.value_ptr_vec, GetReadDivisor(it.name), fast_item_cnt) != DxlError::OK)
+        {
+          return false;
+        }
+      }
+      // sensors get a bulk read of their own, one that does not answer leaves the servos alone
+      for (auto it : use_io_thread_ ? port->io_gpio_sensor_states : port->gpio_sensor_states) {
+        if (port->dxl_comm->SetDxlSensorReadItems(
+          it.id, it.interface_name_vec,
+          it.value_ptr_vec, GetReadDivisor(it.name)) != DxlError::OK)
+        {
+          return false;
+        }
+      }
+      if (port->dxl_comm->SetMultiDxlRead() != DxlError::OK) {
         return false;
       }
     }
-    if (dxl_comm_->SetMultiDxlRead() != DxlError::OK) {
-      return false;
-    }
     return true;
   }
 
@@ -719,150 +1821,205 @@ namespace dynamixel_hardware_interface
             temp_write.name = gpio.name;
 
             temp_write.interface_name_vec.push_back(it.name);
-            temp_write.value_ptr_vec.push_back(std::make_shared<double>(0.0));
+            temp_write.value_ptr_vec.push_back(nullptr);
             hdl_trans_commands_.push_back(temp_write);
           }
         }
       }
+
+      AssignValueStorage(hdl_trans_commands_, trans_command_values_);
+
+      for (auto& port : ports_) {
+        port->trans_commands.clear();
+      }
+      for (const auto& it : hdl_trans_commands_) {
+        GetPort(it.id)->trans_commands.push_back(it);
+      }
+      for (auto& port : ports_) {
+        port->io_trans_commands =
+          CloneHandler(port->trans_commands, port->io_trans_command_values);
+      }
       is_set_hdl = true;
     }
 
-    for (auto it : hdl_trans_commands_) {
-      if (dxl_comm_->SetDxlWriteItems(
-        it.id, it.interface_name_vec,
-        it.value_ptr_vec) != DxlError::OK)
-      {
-        return false;
+    for (auto& port : ports_) {
+      if (port->trans_commands.empty()) {
+        continue;
+      }
+      for (auto it : use_io_thread_ ? port->io_trans_commands : port->trans_commands) {
+        if (port->dxl_comm->SetDxlWriteItems(
+          it.id, it.interface_name_vec,
+          it.value_ptr_vec) != DxlError::OK)
+        {
+          return false;
+        }
       }
-    }
 
-    if (dxl_comm_->SetMultiDxlWrite() != DxlError::OK) {
-      return false;
+      if (port->dxl_comm->SetMultiDxlWrite() != DxlError::OK) {
+        return false;
+      }
     }
 
     return true;
   }
 
-  void DynamixelHardware::ReadSensorData(const HandlerVarType& sensor)
+  uint32_t DynamixelHardware::GetReadDivisor(const std::string& gpio_name)
   {
-    for (auto item : sensor.interface_name_vec) {
-      uint32_t data;
-      dxl_comm_->ReadItem(sensor.id, item, data);
-      for (size_t i = 0; i < hdl_sensor_states_.size(); i++) {
-        for (size_t j = 0; j < hdl_sensor_states_.at(i).interface_name_vec.size(); j++) {
-          if (hdl_sensor_states_.at(i).name == sensor.name &&
-            hdl_sensor_states_.at(i).interface_name_vec.at(j) == item)
-          {
-            *hdl_sensor_states_.at(i).value_ptr_vec.at(j) = data;
+    for (const hardware_interface::ComponentInfo& gpio : info_.gpios) {
+      auto param = gpio.parameters.find("read_divisor");
+      if (gpio.name != gpio_name || param == gpio.parameters.end()) {
+        continue;
+      }
+      try {
+        return static_cast<uint32_t>(std::max(1, stoi(param->second)));
+      }
+      catch (const std::exception& e) {
+        RCLCPP_ERROR(logger_, "Failed to parse read_divisor of %s: %s, reading every cycle", gpio_name.c_str(), e.what());
+      }
+    }
+    return 1;
+  }
+
+  void DynamixelHardware::SetSensorIndex()
+  {
+    sensor_src_value_.clear();
+    sensor_dst_value_.clear();
+    for (const auto& sensor : hdl_gpio_sensor_states_) {
+      for (size_t k = 0; k < sensor.interface_name_vec.size(); k++) {
+        for (const auto& state : hdl_sensor_states_) {
+          for (size_t j = 0; j < state.interface_name_vec.size(); j++) {
+            if (state.name == sensor.name &&
+              state.interface_name_vec.at(j) == sensor.interface_name_vec.at(k))
+            {
+              sensor_src_value_.push_back(sensor.value_ptr_vec.at(k));
+              sensor_dst_value_.push_back(state.value_ptr_vec.at(j));
+            }
           }
         }
       }
     }
   }
 
-  void DynamixelHardware::SetMatrix()
+  bool DynamixelHardware::SetMatrix()
   {
     std::string str;
     std::vector<double> d_vec;
 
-    // dynamic allocation (number_of_transmissions x number_of_joint)
-    transmission_to_joint_matrix_ = new double* [num_of_joints_];
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      transmission_to_joint_matrix_[i] = new double[num_of_transmissions_];
-    }
-
     d_vec.clear();
     std::stringstream ss_tj(info_.hardware_parameters["transmission_to_joint_matrix"]);
     while (std::getline(ss_tj, str, ',')) {
       d_vec.push_back(stod(str));
     }
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      for (size_t j = 0; j < num_of_transmissions_; j++) {
-        transmission_to_joint_matrix_[i][j] = d_vec.at(i * num_of_transmissions_ + j);
-      }
+    if (!transmission_to_joint_matrix_.Set(num_of_joints_, num_of_transmissions_, d_vec)) {
+      RCLCPP_ERROR_STREAM(
+        logger_, "transmission_to_joint_matrix needs " <<
+        num_of_joints_ * num_of_transmissions_ << " values, got " << d_vec.size());
+      return false;
     }
 
-    fprintf(stderr, "transmission_to_joint_matrix_ \n");
+    fprintf(
+      stderr, "transmission_to_joint_matrix_ (%s)\n",
+      TransmissionMatrix::FormToString(transmission_to_joint_matrix_.GetForm()));
     for (size_t i = 0; i < num_of_joints_; i++) {
       for (size_t j = 0; j < num_of_transmissions_; j++) {
-        fprintf(stderr, "[%zu][%zu] %lf, ", i, j, transmission_to_joint_matrix_[i][j]);
+        fprintf(stderr, "[%zu][%zu] %lf, ", i, j, transmission_to_joint_matrix_.At(i, j));
       }
       fprintf(stderr, "\n");
     }
 
-    joint_to_transmission_matrix_ = new double* [num_of_transmissions_];
-    for (size_t i = 0; i < num_of_transmissions_; i++) {
-      joint_to_transmission_matrix_[i] = new double[num_of_joints_];
-    }
-
     d_vec.clear();
     std::stringstream ss_jt(info_.hardware_parameters["joint_to_transmission_matrix"]);
     while (std::getline(ss_jt, str, ',')) {
       d_vec.push_back(stod(str));
     }
-    for (size_t i = 0; i < num_of_transmissions_; i++) {
-      for (size_t j = 0; j < num_of_joints_; j++) {
-        joint_to_transmission_matrix_[i][j] = d_vec.at(i * num_of_joints_ + j);
-      }
+    if (!joint_to_transmission_matrix_.Set(num_of_transmissions_, num_of_joints_, d_vec)) {
+      RCLCPP_ERROR_STREAM(
+        logger_, "joint_to_transmission_matrix needs " <<
+        num_of_joints_ * num_of_transmissions_ << " values, got " << d_vec.size());
+      return false;
     }
 
-
-    fprintf(stderr, "joint_to_transmission_matrix_ \n");
+    fprintf(
+      stderr, "joint_to_transmission_matrix_ (%s)\n",
+      TransmissionMatrix::FormToString(joint_to_transmission_matrix_.GetForm()));
     for (size_t i = 0; i < num_of_transmissions_; i++) {
       for (size_t j = 0; j < num_of_joints_; j++) {
-        fprintf(stderr, "[%zu][%zu] %lf, ", i, j, joint_to_transmission_matrix_[i][j]);
+        fprintf(stderr, "[%zu][%zu] %lf, ", i, j, joint_to_transmission_matrix_.At(i, j));
       }
       fprintf(stderr, "\n");
     }
+    return true;
   }
-  void DynamixelHardware::CalcTransmissionToJoint()
-  {
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      double value = 0.0;
-      for (size_t j = 0; j < num_of_transmissions_; j++) {
-        value += transmission_to_joint_matrix_[i][j] *
-          (*hdl_trans_states_.at(j).value_ptr_vec.at(PRESENT_POSITION_INDEX));
-      }
 
+  void DynamixelHardware::SetConversionIndex()
+  {
+    conversion_joint_index_.clear();
+    for (size_t i = 0; i < hdl_joint_states_.size(); i++) {
       if (hdl_joint_states_.at(i).name == conversion_joint_name_) {
-        value = revoluteToPrismatic(value);
+        conversion_joint_index_.push_back(i);
       }
-      *hdl_joint_states_.at(i).value_ptr_vec.at(PRESENT_POSITION_INDEX) = value;
     }
-
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      double value = 0.0;
-      for (size_t j = 0; j < num_of_transmissions_; j++) {
-        value += transmission_to_joint_matrix_[i][j] *
-          (*hdl_trans_states_.at(j).value_ptr_vec.at(PRESENT_VELOCITY_INDEX));
+    conversion_trans_index_.clear();
+    for (size_t i = 0; i < hdl_trans_commands_.size(); i++) {
+      if (hdl_trans_commands_.at(i).name == conversion_dxl_name_) {
+        conversion_trans_index_.push_back(i);
       }
-      *hdl_joint_states_.at(i).value_ptr_vec.at(PRESENT_VELOCITY_INDEX) = value;
     }
+  }
 
-    for (size_t i = 0; i < num_of_joints_; i++) {
-      double value = 0.0;
-      for (size_t j = 0; j < num_of_transmissions_; j++) {
-        value += transmission_to_joint_matrix_[i][j] *
-          (*hdl_trans_states_.at(j).value_ptr_vec.at(PRESENT_EFFORT_INDEX));
+  void DynamixelHardware::SetErrorIndex()
+  {
+    dxl_hw_err_.assign(hdl_trans_states_.size(), 0x00);
+    hw_err_trans_index_.clear();
+    hw_err_value_.clear();
+    for (size_t i = 0; i < hdl_trans_states_.size(); i++) {
+      for (size_t j = 0; j < hdl_trans_states_.at(i).interface_name_vec.size(); j++) {
+        if (hdl_trans_states_.at(i).interface_name_vec.at(j) == "Hardware Error Status") {
+          hw_err_trans_index_.push_back(i);
+          hw_err_value_.push_back(hdl_trans_states_.at(i).value_ptr_vec.at(j));
+        }
+      }
+    }
+    hw_state_value_.clear();
+    for (const auto& joint : hdl_joint_states_) {
+      for (size_t j = 0; j < joint.interface_name_vec.size(); j++) {
+        if (joint.interface_name_vec.at(j) == HW_IF_HARDWARE_STATE) {
+          hw_state_value_.push_back(joint.value_ptr_vec.at(j));
+        }
       }
-      *hdl_joint_states_.at(i).value_ptr_vec.at(PRESENT_EFFORT_INDEX) = value;
     }
   }
 
-  void DynamixelHardware::CalcJointToTransmission()
+  void DynamixelHardware::CalcTransmissionToJoint()
   {
-    for (size_t i = 0; i < num_of_transmissions_; i++) {
-      double value = 0.0;
-      for (size_t j = 0; j < num_of_joints_; j++) {
-        value += joint_to_transmission_matrix_[i][j] *
-          (*hdl_joint_commands_.at(j).value_ptr_vec.at(0));
-      }
+    // position, velocity and effort columns of the transmission and joint state storage
+    const double* in[TransmissionMatrix::MAX_VECTOR_CNT];
+    double* out[TransmissionMatrix::MAX_VECTOR_CNT];
+    size_t vector_cnt = std::min(
+      trans_state_values_.ColumnCount(), TransmissionMatrix::MAX_VECTOR_CNT);
+    for (size_t k = 0; k < vector_cnt; k++) {
+      in[k] = trans_state_values_.Column(k);
+      out[k] = joint_state_values_.Column(k);
+    }
+    transmission_to_joint_matrix_.Apply(in, out, vector_cnt);
 
-      if (hdl_trans_commands_.at(i).name == conversion_dxl_name_) {
-        value = prismaticToRevolute(value);
-      }
+    for (auto i : conversion_joint_index_) {
+      out[PRESENT_POSITION_INDEX][i] = revoluteToPrismatic(out[PRESENT_POSITION_INDEX][i]);
+    }
+  }
+
+  void DynamixelHardware::CalcJointToTransmission()
+  {
+    // first command of every joint and transmission handler
+    if (joint_command_values_.ColumnCount() == 0 || trans_command_values_.ColumnCount() == 0) {
+      return;
+    }
+    const double* in[1] = {joint_command_values_.Column(0)};
+    double* out[1] = {trans_command_values_.Column(0)};
+    joint_to_transmission_matrix_.Apply(in, out, 1);
 
-      *hdl_trans_commands_.at(i).value_ptr_vec.at(0) = value;
+    for (auto i : conversion_trans_index_) {
+      out[0][i] = prismaticToRevolute(out[0][i]);
     }
   }
 
@@ -889,18 +2046,42 @@ namespace dynamixel_hardware_interface
 
   void DynamixelHardware::ChangeDxlTorqueState()
   {
-    if (dxl_torque_status_ == REQUESTED_TO_ENABLE) {
-      std::cout << "torque enable" << std::endl;
-      dxl_comm_->DynamixelEnable(dxl_id_);
+    if (!torque_change_running_ &&
+      (dxl_torque_status_ == REQUESTED_TO_ENABLE || dxl_torque_status_ == REQUESTED_TO_DISABLE))
+    {
+      bool enable = dxl_torque_status_ == REQUESTED_TO_ENABLE;
+      std::cout << (enable ? "torque enable" : "torque disable") << std::endl;
+      // the commands written with the change hold the current states
       SyncJointCommandWithStates();
+      for (auto& port : ports_) {
+        PostTorqueChange(*port, enable, -1);
+      }
+      torque_change_running_ = true;
     }
-    else if (dxl_torque_status_ == REQUESTED_TO_DISABLE) {
-      std::cout << "torque disable" << std::endl;
-      dxl_comm_->DynamixelDisable(dxl_id_);
-      SyncJointCommandWithStates();
+
+    if (!use_io_thread_) {
+      if (torque_change_running_) {
+        // every port changes on its own thread, no port waits for another's bus
+        RunPortJobs(PORT_JOB_TORQUE);
+      }
+      for (auto& port : ports_) {
+        std::lock_guard<std::mutex> lock(port->mutex);
+        for (const auto& single_torque_state : port->dxl_comm->GetDxlTorqueState()) {
+          dxl_torque_state_[single_torque_state.first] = single_torque_state.second;
+        }
+      }
+    }
+    // with I/O threads, dxl_torque_state_ and torque_done_seq come with the state snapshots
+
+    if (torque_change_running_) {
+      for (auto& port : ports_) {
+        if (port->torque_done_seq != port->torque_seq) {
+          return;
+        }
+      }
+      torque_change_running_ = false;
     }
 
-    dxl_torque_state_ = dxl_comm_->GetDxlTorqueState();
     for (auto single_torque_state : dxl_torque_state_) {
       if (single_torque_state.second == false) {
         dxl_torque_status_ = TORQUE_DISABLED;
@@ -917,7 +2098,15 @@ namespace dynamixel_hardware_interface
     uint8_t id = static_cast<uint8_t>(request->id);
     std::string name = request->item_name;
 
-    if (dxl_comm_->InsertReadItemBuf(id, name) != DxlError::OK) {
+    DxlPortType* port = GetPort(id);
+    if (port == nullptr) {
+      RCLCPP_ERROR_STREAM(logger_, "get_dxl_data_srv_callback unknown ID " << static_cast<int>(id));
+      response->result = false;
+      return;
+    }
+
+    std::unique_lock<std::mutex> lock(port->mutex);
+    if (port->dxl_comm->InsertReadItemBuf(id, name) != DxlError::OK) {
       RCLCPP_ERROR_STREAM(logger_, "get_dxl_data_srv_callback InsertReadItemBuf");
 
       response->result = false;
@@ -928,7 +2117,7 @@ namespace dynamixel_hardware_interface
       timeout_sec = 1.0;
     }
     rclcpp::Time t_start = rclcpp::Clock().now();
-    while (dxl_comm_->CheckReadItemBuf(id, name) == false) {
+    while (port->dxl_comm->CheckReadItemBuf(id, name) == false) {
       if ((rclcpp::Clock().now() - t_start).seconds() > timeout_sec) {
         RCLCPP_ERROR_STREAM(
           logger_,
@@ -936,9 +2125,13 @@ namespace dynamixel_hardware_interface
         response->result = false;
         return;
       }
+      // give the port thread the bus to serve the request
+      lock.unlock();
+      std::this_thread::yield();
+      lock.lock();
     }
 
-    response->item_data = dxl_comm_->GetReadItemDataBuf(id, name);
+    response->item_data = port->dxl_comm->GetReadItemDataBuf(id, name);
     response->result = true;
   }
 
@@ -948,7 +2141,14 @@ namespace dynamixel_hardware_interface
   {
     uint8_t dxl_id = static_cast<uint8_t>(request->id);
     uint32_t dxl_data = static_cast<uint32_t>(request->item_data);
-    if (dxl_comm_->InsertWriteItemBuf(dxl_id, request->item_name, dxl_data) == DxlError::OK) {
+    DxlPortType* port = GetPort(dxl_id);
+    if (port == nullptr) {
+      response->result = false;
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(port->mutex);
+    if (port->dxl_comm->InsertWriteItemBuf(dxl_id, request->item_name, dxl_data) == DxlError::OK) {
       response->result = true;
     }
     else {
@@ -960,7 +2160,16 @@ namespace dynamixel_hardware_interface
     const std::shared_ptr<dynamixel_msgs::srv::RebootDxl::Request> request,
     std::shared_ptr<dynamixel_msgs::srv::RebootDxl::Response> response)
   {
-    if (CommReset()) {
+    // the control loop hands the bus over, the reset itself runs here on the executor thread
+    if (!CallControlLoop(REQUEST_REBOOT, 0, false, std::chrono::seconds(1))) {
+      response->result = false;
+      RCLCPP_INFO_STREAM(logger_, "[reboot_dxl_srv_callback] FAIL");
+      return;
+    }
+    bool result = CommReset();
+    comm_reset_running_ = false;
+
+    if (result) {
       response->result = true;
       RCLCPP_INFO_STREAM(logger_, "[reboot_dxl_srv_callback] SUCCESS");
     }
@@ -974,55 +2183,25 @@ namespace dynamixel_hardware_interface
     const std::shared_ptr<std_srvs::srv::SetBool::Request> request,
     std::shared_ptr<std_srvs::srv::SetBool::Response> response)
   {
-    if (request->data) {
-      if (dxl_torque_status_ == TORQUE_ENABLED) {
-        response->success = true;
-        response->message = "Already enabled.";
-        return;
-      }
-      else {
-        dxl_torque_status_ = REQUESTED_TO_ENABLE;
-      }
+    if (request->data && dxl_torque_status_ == TORQUE_ENABLED) {
+      response->success = true;
+      response->message = "Already enabled.";
+      return;
     }
-    else {
-      if (dxl_torque_status_ == TORQUE_DISABLED) {
-        response->success = true;
-        response->message = "Already disabled.";
-        return;
-      }
-      else {
-        dxl_torque_status_ = REQUESTED_TO_DISABLE;
-      }
+    if (!request->data && dxl_torque_status_ == TORQUE_DISABLED) {
+      response->success = true;
+      response->message = "Already disabled.";
+      return;
     }
 
-    auto start = std::chrono::steady_clock::now();
-    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
-      if (dxl_torque_status_ == TORQUE_ENABLED) {
-        if (request->data) {
-          response->success = true;
-          response->message = "Success to enable.";
-        }
-        else {
-          response->success = false;
-          response->message = "Fail to enable.";
-        }
-        return;
-      }
-      else if (dxl_torque_status_ == TORQUE_DISABLED) {
-        if (!request->data) {
-          response->success = true;
-          response->message = "Success to disable.";
-        }
-        else {
-          response->success = false;
-          response->message = "Fail to disable.";
-        }
-        return;
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (CallControlLoop(REQUEST_TORQUE, 0, request->data, std::chrono::seconds(1))) {
+      response->success = true;
+      response->message = request->data ? "Success to enable." : "Success to disable.";
+    }
+    else {
+      response->success = false;
+      response->message = request->data ? "Fail to enable." : "Fail to disable.";
     }
-    response->success = false;
-    response->message = "Fail to write requeset. main thread is not running.";
   }
 
   void DynamixelHardware::set_dxl_torque_id_srv_callback(
@@ -1032,21 +2211,16 @@ namespace dynamixel_hardware_interface
     std::vector<uint8_t> ids = request->id;
     bool torque_enable = request->enable;
 
-    if (torque_enable) {
-      if (dxl_comm_->DynamixelEnable(ids) != DxlError::OK) {
-        response->result = false;
-        return;
-      }
-    }
-    else {
-      if (dxl_comm_->DynamixelDisable(ids) != DxlError::OK) {
+    for (auto id : ids) {
+      if (GetPort(id) == nullptr ||
+        !CallControlLoop(REQUEST_TORQUE_ID, id, torque_enable, std::chrono::seconds(1)))
+      {
         response->result = false;
         return;
       }
     }
 
     response->result = true;
-
   }
 
   void DynamixelHardware::initRevoluteToPrismaticParam()
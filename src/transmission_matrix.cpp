@@ -0,0 +1,154 @@
+// Copyright 2024 ROBOTIS CO., LTD.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Authors: Hye-Jong KIM, Sungho Woo
+
+#include "dynamixel_hardware_interface/transmission_matrix.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace dynamixel_hardware_interface
+{
+
+TransmissionMatrix::TransmissionMatrix()
+: rows_(0), cols_(0), form_(DENSE) {}
+
+bool TransmissionMatrix::Set(size_t rows, size_t cols, const std::vector<double> & values)
+{
+  if (values.size() != rows * cols) {
+    return false;
+  }
+  rows_ = rows;
+  cols_ = cols;
+  value_ = values;
+  index_.clear();
+  scale_.clear();
+  row_begin_.clear();
+  col_.clear();
+  nonzero_.clear();
+  dense_.Allocate(std::vector<size_t>());
+
+  // CSR of the matrix, kept for the SPARSE form
+  row_begin_.push_back(0);
+  bool one_per_row = true;
+  for (size_t i = 0; i < rows_; i++) {
+    for (size_t j = 0; j < cols_; j++) {
+      if (value_.at(i * cols_ + j) != 0.0) {
+        col_.push_back(j);
+        nonzero_.push_back(value_.at(i * cols_ + j));
+      }
+    }
+    row_begin_.push_back(col_.size());
+    one_per_row = one_per_row && row_begin_.at(i + 1) - row_begin_.at(i) == 1;
+  }
+
+  if (one_per_row) {
+    bool identity = rows_ == cols_;
+    for (size_t i = 0; i < rows_; i++) {
+      index_.push_back(col_.at(i));
+      scale_.push_back(nonzero_.at(i));
+      identity = identity && col_.at(i) == i && nonzero_.at(i) == 1.0;
+    }
+    form_ = identity ? IDENTITY : PERMUTATION;
+  } else if (nonzero_.size() * 2 <= rows_ * cols_) {
+    form_ = SPARSE;
+  } else {
+    form_ = DENSE;
+    dense_.Allocate(std::vector<size_t>(rows_, cols_));
+    for (size_t i = 0; i < rows_; i++) {
+      for (size_t j = 0; j < cols_; j++) {
+        dense_.Column(j)[i] = value_.at(i * cols_ + j);
+      }
+    }
+  }
+
+  if (form_ != SPARSE) {
+    row_begin_.clear();
+    col_.clear();
+    nonzero_.clear();
+  }
+  return true;
+}
+
+void TransmissionMatrix::Apply(
+  const double * const * in, double * const * out, size_t vector_cnt) const
+{
+  vector_cnt = std::min(vector_cnt, MAX_VECTOR_CNT);
+
+  switch (form_) {
+    case IDENTITY:
+      for (size_t k = 0; k < vector_cnt; k++) {
+        std::copy(in[k], in[k] + rows_, out[k]);
+      }
+      break;
+
+    case PERMUTATION:
+      for (size_t i = 0; i < rows_; i++) {
+        const double scale = scale_[i];
+        const size_t index = index_[i];
+        for (size_t k = 0; k < vector_cnt; k++) {
+          out[k][i] = scale * in[k][index];
+        }
+      }
+      break;
+
+    case SPARSE:
+      for (size_t i = 0; i < rows_; i++) {
+        double sum[MAX_VECTOR_CNT] = {0.0, 0.0, 0.0};
+        for (size_t p = row_begin_[i]; p < row_begin_[i + 1]; p++) {
+          const double value = nonzero_[p];
+          const size_t col = col_[p];
+          for (size_t k = 0; k < vector_cnt; k++) {
+            sum[k] += value * in[k][col];
+          }
+        }
+        for (size_t k = 0; k < vector_cnt; k++) {
+          out[k][i] = sum[k];
+        }
+      }
+      break;
+
+    case DENSE:
+    default:
+      for (size_t k = 0; k < vector_cnt; k++) {
+        std::fill(out[k], out[k] + rows_, 0.0);
+      }
+      // every matrix column is loaded once for all vectors, the inner loop vectorizes
+      for (size_t j = 0; j < cols_; j++) {
+        const double * column = dense_.Column(j);
+        for (size_t k = 0; k < vector_cnt; k++) {
+          const double x = in[k][j];
+          double * o = out[k];
+          for (size_t i = 0; i < rows_; i++) {
+            o[i] += column[i] * x;
+          }
+        }
+      }
+      break;
+  }
+}
+
+const char * TransmissionMatrix::FormToString(Form form)
+{
+  switch (form) {
+    case IDENTITY: return "identity";
+    case PERMUTATION: return "permutation";
+    case SPARSE: return "sparse";
+    case DENSE: return "dense";
+    default: return "unknown";
+  }
+}
+
+}  // namespace dynamixel_hardware_interface